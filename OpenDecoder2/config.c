@@ -20,6 +20,10 @@
 //            2007-08-06 V0.04 changed to CV-struct
 //            2010-09-14 V0.05 added reverser
 //            2011-09-22 V0.06 RGB added
+//            2026-10-17          EE_sequence (light sequences)
+//            2026-10-17          frameval (servo frames)
+//            2026-10-17          EE_Sv_Vmax, EE_Sv_Amax, EE_Sv_Jmax (SERVO_PLAN)
+//            2026-10-17          EE_servo_curves: directory and delta coded curves
 //
 //------------------------------------------------------------------------
 //
@@ -48,8 +52,9 @@
 #include "config.h"
 #include "hardware.h"
 #include "dcc_receiver.h"
+#include "sequence.h"            // opcodes for EE_sequence
 //#include "port_engine.h"
-// #include "servo.h"
+#include "servo.h"               // codes for EE_servo_curves
 
 //#include "main.h"
 
@@ -65,8 +70,8 @@
 #define TICK_PERIOD 20000L       // 20ms tick for Timing Engine
                                  // => possible values for timings up to
                                  //    5.1s (=255/0.020)
-                                 // note: this is also used as frame for
-                                 // Servo-Outputs (OC1A and OC1B)
+                                 // note: timer1 runs with SERVO_FRAME (config.h),
+                                 // the frame for Servo-Outputs (OC1A and OC1B)
 
 //----------------------------------------------------------------------------
 // Global Data
@@ -75,6 +80,9 @@
 volatile signed char timerval;          // generell timer tick, this is incremented
                                         // by Timer-ISR, wraps around
 
+volatile unsigned char frameval;        // servo frame, incremented at every timer1
+                                        // period (SERVO_FRAME), wraps around
+
 volatile unsigned char Communicate = 0; // Communicationregister (for semaphors)
    
 
@@ -111,15 +119,60 @@ volatile unsigned char Communicate = 0; // Communicationregister (for semaphors)
         #include "cv_data_servo.h"
       };
 
-    unsigned char EE_servo_curve1[48] EEMEM;  // these are pairs of time/positions - see servo.c
-    unsigned char EE_servo_curve2[48] EEMEM;
-    unsigned char EE_servo_curve3[48] EEMEM;
-    unsigned char EE_servo_curve4[48] EEMEM;
+    unsigned char EE_servo_curves[SV_CURVE_POOL] EEMEM =     // user curves - see servo.c
+      {
+        16, 30, 0, 0, 0, 0, 0, 0,           // directory: user curve 1..16
+        0, 0, 0, 0, 0, 0, 0, 0,             // (0 = no curve)
+
+        // user curve 1 (16): like move_A
+        25,
+        SVC_STEP(1, 4), SVC_STEP(1, 10), SVC_STEP(1, 16), SVC_STEP(1, 22),
+        SVC_JUMP(2), 128, SVC_JUMP(2), 180,
+        SVC_STEP(1, 21), SVC_STEP(1, 16), SVC_STEP(1, 10), SVC_STEP(1, 4),
+        SVC_END,
+
+        // user curve 2 (30): like move_B
+        231,
+        SVC_STEP(1, -4), SVC_STEP(1, -10), SVC_STEP(1, -16), SVC_STEP(1, -21),
+        SVC_JUMP(2), 128, SVC_JUMP(2), 77,
+        SVC_STEP(1, -22), SVC_STEP(1, -16), SVC_STEP(1, -10), SVC_STEP(1, -4),
+        SVC_END,
+      };
 
     const t_cv_record CV_PRESET PROGMEM =
       {
         #include "cv_data_servo.h"
       };
+
+#if (SEQUENCE_ENABLED == TRUE)
+    unsigned char EE_sequence[SEQ_SIZE] EEMEM =     // CV449..CV512, see sequence.c
+      {
+        4, 40, SEQ_NONE, SEQ_NONE,          // start of sequence 0..3
+
+        // 4: sequence 0 - construction site flasher (like port*_bst):
+        //    each output flashes for 20ms, 100ms after the previous one
+        SEQ_SET+0, SEQ_WAIT_N+1, SEQ_CLR+0, SEQ_WAIT_N+4,
+        SEQ_SET+1, SEQ_WAIT_N+1, SEQ_CLR+1, SEQ_WAIT_N+4,
+        SEQ_SET+2, SEQ_WAIT_N+1, SEQ_CLR+2, SEQ_WAIT_N+4,
+        SEQ_SET+3, SEQ_WAIT_N+1, SEQ_CLR+3, SEQ_WAIT_N+4,
+        SEQ_SET+4, SEQ_WAIT_N+1, SEQ_CLR+4, SEQ_WAIT_N+4,
+        SEQ_SET+5, SEQ_WAIT_N+1, SEQ_CLR+5, SEQ_WAIT_N+4,
+        SEQ_SET+6, SEQ_WAIT_N+1, SEQ_CLR+6, SEQ_WAIT_N+4,
+        SEQ_SET+7, SEQ_WAIT_N+1, SEQ_CLR+7, SEQ_WAIT_N+4,
+        SEQ_WAIT, 16,                       // period 56 ticks = 1.12s
+        SEQ_JUMP, 4,
+
+        // 40: sequence 1 - welding light on output 0: 16 random
+        //     flashes, then a random pause up to 5s
+        SEQ_SET+0, SEQ_RANDOM, 3,
+        SEQ_CLR+0, SEQ_RANDOM, 2,
+        SEQ_LOOP+15, 40,
+        SEQ_RANDOM, 250,
+        SEQ_JUMP, 40,
+
+        [52 ... SEQ_SIZE-1] = SEQ_END,
+      };
+#endif
 /*
 #elif (DMX_ENABLED == TRUE)
    const unsigned char compilat[] PROGMEM = {".... DMX ...."};
@@ -244,7 +297,7 @@ unsigned char EE_Sv1_CurveA EEMEM =    9;  // 5; //558  46  -      Servo 1 Curve
 unsigned char EE_Sv1_TimeA  EEMEM = 1; //559  47  -      Servo 1 Curve Time stretch A
 unsigned char EE_Sv1_CurveB EEMEM =    10; //6; //560  48  -      Servo 1 Curve Movement B
 unsigned char EE_Sv1_TimeB  EEMEM = 1; //561  49  -      Servo 1 Curve Time stretch B
-unsigned char EE_Sv1_res    EEMEM =    0; //562  50  -      Servo 1 reserved
+unsigned char EE_Sv1_Frame  EEMEM =    0; //562  50  -      Servo 1 Frame: 0=20ms, 1=SERVO_FRAME
 
 unsigned char EE_Sv2_minL   EEMEM =    0; //563  51  -      Servo 2 Min low
 unsigned char EE_Sv2_min    EEMEM =   10; //564  52  -      Servo 2 Min high
@@ -257,7 +310,7 @@ unsigned char EE_Sv2_CurveA EEMEM =   13; //570  58  -      Servo 2 Curve Moveme
 unsigned char EE_Sv2_TimeA  EEMEM =    4; //571  59  -      Servo 2 Curve Time stretch A
 unsigned char EE_Sv2_CurveB EEMEM =   15; //572  60  -      Servo 2 Curve Movement B
 unsigned char EE_Sv2_TimeB  EEMEM =    5; //573  61  -      Servo 2 Curve Time stretch B
-unsigned char EE_Sv2_res    EEMEM =    0; //574  62  -      Servo 2 reserved
+unsigned char EE_Sv2_Frame  EEMEM =    0; //574  62  -      Servo 2 Frame: 0=20ms, 1=SERVO_FRAME
 
 unsigned char EE_575        EEMEM =    0; //575  63  -      reserved
 
@@ -291,16 +344,13 @@ unsigned char EE_Pos8_L     EEMEM =    0; //594  ??  -      Servo 1 Position H,
 unsigned char EE_Pos8_H     EEMEM =  250; //595  ??  -      Servo 1 Position H, high part
 
 
-unsigned char EE_596        EEMEM =    0; //596  ??  -      reserved
-unsigned char EE_597        EEMEM =    0; //597  ??  -      reserved
-unsigned char EE_598        EEMEM =    0; //598  ??  -      reserved
+unsigned char EE_Sv_Vmax    EEMEM =   20; //596  ??  -      Servo max. velocity [us per 20ms]
+unsigned char EE_Sv_Amax    EEMEM =   16; //597  ??  -      Servo max. acceleration [1/16 us per 20ms^2]
+unsigned char EE_Sv_Jmax    EEMEM =    8; //598  ??  -      Servo max. jerk [1/64 us per 20ms^3]
 unsigned char EE_599        EEMEM =    0; //599  ??  -      reserved
 
 
-unsigned char EE_servo_curve1[48] EEMEM;  // these are pairs of time/positions - see servo.c
-unsigned char EE_servo_curve2[48] EEMEM;
-unsigned char EE_servo_curve3[48] EEMEM;
-unsigned char EE_servo_curve4[48] EEMEM;
+unsigned char EE_servo_curves[192] EEMEM; // directory and delta coded curves - see servo.c
 #endif // SERVO_ENABLED
 
 
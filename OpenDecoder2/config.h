@@ -25,6 +25,18 @@
 //            2008-12-14 V0.11 kw added selectable power up sequence
 //            2010-09-15 V0.12 kw added REVERSER_ENABLED
 //            2011-12-08 V0.12 kw added Hardware OPENDECODER28
+//            2026-10-17          added HOST_BUILD (native build in host/)
+//            2026-10-17          added RAILCOM_ENABLED
+//            2026-10-17          added DCC_DEDUP
+//            2026-10-17          added FUNCTION_ENABLED
+//            2026-10-17          added DCC_HEALTH
+//            2026-10-17          added DCC_PREFILTER
+//            2026-10-17          added DIMMER_ENABLED
+//            2026-10-17          added SEQUENCE_ENABLED
+//            2026-10-17          added SERVO_MUX
+//            2026-10-17          added SERVO_FRAME
+//            2026-10-17          added SERVO_PLAN
+//            2026-10-17          EE_servo_curves (delta coded curves)
 //
 //------------------------------------------------------------------------
 //
@@ -92,7 +104,9 @@
 #define ARDUINDOPROMINI 4
 #define CSMD 5
 
+#ifndef TARGET_HARDWARE                // may be preset by the makefile
 #define TARGET_HARDWARE     CSMD
+#endif
 
 
 #define FALSE  0
@@ -104,6 +118,16 @@
 
 #define DEBUG  0
 
+
+// Host build:     FALSE: firmware for the AVR (default/Makefile)
+//                 TRUE:  native build for a PC (host/Makefile); registers,
+//                        eeprom and timers are replaced by the stand-ins
+//                        in host/, interrupts are run by a simulated clock.
+
+#ifndef HOST_BUILD
+#define HOST_BUILD  FALSE
+#endif
+
 //-------------------------------------------------------------------------------------------
 // 1.b) Configuration of Software Modules
 //
@@ -130,6 +154,44 @@
 
 #define SEGMENT_ENABLED   FALSE     // TRUE: include multi position Servodecoder
 
+#ifndef SERVO_MUX                   // may be preset by the makefile
+#define SERVO_MUX         FALSE     // TRUE: 8 servos on the outputs instead of 2 on OC1A/OC1B
+#endif                              //       (requires ALTERNATE_RECEIVE 2, uses timer0)
+
+#ifndef SERVO_FRAME                 // may be preset by the makefile
+#define SERVO_FRAME       20000L    // us, frame of the servo pulses = period of timer1:
+#endif                              //       20000, 10000 or 5000 (see TICK_PERIOD)
+
+#ifndef SERVO_PLAN                  // may be preset by the makefile
+#define SERVO_PLAN        FALSE     // TRUE: servo curve 16 is a jerk limited move, planned
+#endif                              //       with CV596..598 (velocity, acceleration, jerk)
+
+#ifndef FUNCTION_ENABLED            // may be preset by the makefile
+#define FUNCTION_ENABLED  FALSE     // TRUE: function decoder on a loco address (mode 48)
+#endif
+
+#ifndef DIMMER_ENABLED              // may be preset by the makefile
+#define DIMMER_ENABLED    FALSE     // TRUE: soft PWM dimmer on the outputs (mode 4, requires
+#endif                              //       ALTERNATE_RECEIVE 2, uses timer0)
+
+#ifndef SEQUENCE_ENABLED            // may be preset by the makefile
+#define SEQUENCE_ENABLED  FALSE     // TRUE: light sequences, programmed by CV (mode 6)
+#endif
+
+#ifndef RAILCOM_ENABLED             // may be preset by the makefile
+#define RAILCOM_ENABLED   FALSE     // TRUE: RailCom channel 1+2 (requires OPENDECODER3
+#endif                              //       and ALTERNATE_RECEIVE 2)
+
+#define DCC_DEDUP         TRUE      // TRUE: repeats of an accessory command are dropped
+                                    //       in analyze_message (see dcc_decode.c)
+
+#define DCC_HEALTH        TRUE      // TRUE: receiver error counters (dcc_health),
+                                    //       readable as CV13..CV24
+
+#ifndef DCC_PREFILTER               // may be preset by the makefile
+#define DCC_PREFILTER     TRUE      // TRUE: the receiver checks the XOR and queues only
+#endif                              //       packets which may be for us (dcc_receiver.h)
+
 
 //-------------------------------------------------------------------------------------------
 // Decoder Model Configuration Check
@@ -165,6 +227,12 @@
   #undef SEGMENT_ENABLED
   #define SEGMENT_ENABLED   FALSE
  #endif
+ #undef SERVO_MUX
+ #define SERVO_MUX   FALSE
+ #undef SERVO_FRAME
+ #define SERVO_FRAME TICK_PERIOD
+ #undef SERVO_PLAN
+ #define SERVO_PLAN  FALSE
 #endif
 
 #if (TARGET_HARDWARE == OPENDECODER28)
@@ -175,6 +243,35 @@
    #endif
 #endif
 
+#if (TARGET_HARDWARE != OPENDECODER3)
+   #if (RAILCOM_ENABLED == TRUE)
+     #warning: RAILCOM needs the uart of OPENDECODER3 - RAILCOM has been disabled
+     #undef RAILCOM_ENABLED
+     #define RAILCOM_ENABLED   FALSE
+   #endif
+#endif
+
+#if (RAILCOM_ENABLED == TRUE)
+   #if (DIMMER_ENABLED == TRUE)
+     #warning: RAILCOM needs timer0 - DIMMER has been disabled
+     #undef DIMMER_ENABLED
+     #define DIMMER_ENABLED   FALSE
+   #endif
+   #if (SERVO_MUX == TRUE)
+     #warning: RAILCOM needs timer0 - SERVO_MUX has been disabled
+     #undef SERVO_MUX
+     #define SERVO_MUX   FALSE
+   #endif
+#endif
+
+#if (SERVO_MUX == TRUE)
+   #if (DIMMER_ENABLED == TRUE)
+     #warning: SERVO_MUX needs timer0 - DIMMER has been disabled
+     #undef DIMMER_ENABLED
+     #define DIMMER_ENABLED   FALSE
+   #endif
+#endif
+
 
 //------------------------------------------------------------------------------------------
 // Servo Power up
@@ -204,6 +301,9 @@
 
 #define CV_REMAPPING   TRUE              // if true: remap cv 513 to cv 1 aso;
 
+#define EEPROM_CACHE   TRUE              // TRUE: CVs are kept in RAM, eeprom is written
+                                         //       in the background (see myeeprom.c)
+
 #include "cv_define.h"
 
 extern t_cv_record CV EEMEM;
@@ -277,7 +377,7 @@ extern unsigned char EE_Sv1_CurveA EEMEM; //558  ??  -      Servo 1 Curve Moveme
 extern unsigned char EE_Sv1_TimeA  EEMEM; //559  ??  -      Servo 1 Curve Time stretch A
 extern unsigned char EE_Sv1_CurveB EEMEM; //560  ??  -      Servo 1 Curve Movement A
 extern unsigned char EE_Sv1_TimeB  EEMEM; //561  ??  -      Servo 1 Curve Time stretch B
-extern unsigned char EE_Sv1_res    EEMEM; //562  ??  -      Servo 1 reserved
+extern unsigned char EE_Sv1_Frame  EEMEM; //562  ??  -      Servo 1 Frame
 
 extern unsigned char EE_Sv2_minL   EEMEM; //563  ??  -      Servo 2 Min (low part, reserved)
 extern unsigned char EE_Sv2_min    EEMEM; //564  ??  -      Servo 2 Min
@@ -290,7 +390,7 @@ extern unsigned char EE_Sv2_CurveA EEMEM; //570  ??  -      Servo 2 Curve Moveme
 extern unsigned char EE_Sv2_TimeA  EEMEM; //571  ??  -      Servo 2 Curve Time stretch A
 extern unsigned char EE_Sv2_CurveB EEMEM; //572  ??  -      Servo 2 Curve Movement A
 extern unsigned char EE_Sv2_TimeB  EEMEM; //573  ??  -      Servo 2 Curve Time stretch B
-extern unsigned char EE_Sv2_res    EEMEM; //574  ??  -      Servo 2 reserved
+extern unsigned char EE_Sv2_Frame  EEMEM; //574  ??  -      Servo 2 Frame
 
 extern unsigned char EE_575        EEMEM; //575  ??  -      reserved
 
@@ -322,27 +422,25 @@ extern unsigned char EE_Pos7_H     EEMEM; //593  ??  -      Servo 1 Position G,
 extern unsigned char EE_Pos8_L     EEMEM; //594  ??  -      Servo 1 Position H, low part
 extern unsigned char EE_Pos8_H     EEMEM; //595  ??  -      Servo 1 Position H, high part
 
-extern unsigned char EE_596        EEMEM; //596  ??  -      reserved
-extern unsigned char EE_597        EEMEM; //597  ??  -      reserved
-extern unsigned char EE_598        EEMEM; //598  ??  -      reserved
+extern unsigned char EE_Sv_Vmax    EEMEM; //596  ??  -      Servo max. velocity (curve 16)
+extern unsigned char EE_Sv_Amax    EEMEM; //597  ??  -      Servo max. acceleration (curve 16)
+extern unsigned char EE_Sv_Jmax    EEMEM; //598  ??  -      Servo max. jerk (curve 16)
 extern unsigned char EE_599        EEMEM; //599  ??  -      reserved
 
 
-extern unsigned char EE_servo_curve1[48] EEMEM;
-extern unsigned char EE_servo_curve2[48] EEMEM;
-extern unsigned char EE_servo_curve3[48] EEMEM;
-extern unsigned char EE_servo_curve4[48] EEMEM;
+extern unsigned char EE_servo_curves[192] EEMEM;
 #endif // SERVO_ENABLED
 
 */
 
 #if (SERVO_ENABLED == TRUE)
-extern unsigned char EE_servo_curve1[48] EEMEM;
-extern unsigned char EE_servo_curve2[48] EEMEM;
-extern unsigned char EE_servo_curve3[48] EEMEM;
-extern unsigned char EE_servo_curve4[48] EEMEM;
+extern unsigned char EE_servo_curves[] EEMEM;   // user curves, see servo.c
 #endif // SERVO_ENABLED
 
+#if (SEQUENCE_ENABLED == TRUE)
+extern unsigned char EE_sequence[] EEMEM;   // CV449..CV512, see sequence.c
+#endif
+
 //========================================================================
 // 3. Global variables
 //========================================================================
@@ -354,12 +452,20 @@ extern unsigned char EE_servo_curve4[48] EEMEM;
 #define TICK_PERIOD 20000L       // 20ms tick for Timing Engine
                                  // => possible values for timings up to
                                  //    5.1s (=255/0.020)
-                                 // note: this is also used as frame for
-                                 // Servo-Outputs (OC1A and OC1B)
+                                 // note: timer1 runs with a period of SERVO_FRAME,
+                                 // this is the frame for Servo-Outputs (OC1A and OC1B);
+                                 // the timetick is every SERVO_FRAMES periods
+
+#define SERVO_FRAMES (TICK_PERIOD / SERVO_FRAME)   // servo frames per timetick
+
+#if ((SERVO_FRAMES * SERVO_FRAME != TICK_PERIOD) || (SERVO_FRAMES > 4))
+  #error: SERVO_FRAME must be 20000, 10000 or 5000
+#endif
 
 //----------------------------------------------------------------------------
 
 extern volatile signed char timerval;    // gets incremented in the timetick
+extern volatile unsigned char frameval;  // gets incremented every timer1 period (SERVO_FRAME)
 
 
 
@@ -382,8 +488,8 @@ extern volatile signed char timerval;    // gets incremented in the timetick
 extern volatile unsigned char Communicate;
 
 
-#define C_Received        0    // a new DCC was received - issued by ISR(Timer1)
-                               //                          cleared by main
+#define C_Received        0    // unused - received messages are in dcc_queue
+                               //          (see dcc_receiver.h)
 #define C_DoSave          1    // a new PORT state should be saved
                                //                        - issued by action
                                //                          cleared by main
@@ -426,6 +532,18 @@ unsigned char semaphor_get(unsigned char flag)
   }
         
 
+//------------------------------------------------------------------------
+// Host build: busy waits on timerval must let the simulated clock run,
+// on the AVR this is empty.
+//------------------------------------------------------------------------
+
+#if (HOST_BUILD == TRUE)
+  #include "host_hal.h"
+  #define HOST_WAIT()   host_poll()
+#else
+  #define HOST_WAIT()
+#endif
+
 //------------------------------------------------------------------------
 // Delay-Macro (all values in us) -> this is busy waiting
 //------------------------------------------------------------------------
@@ -464,12 +582,16 @@ _restart(void)
     // void (*funcptr)( void ) = 0x0000;    // Set up function pointer
     // funcptr();                        // Jump to Reset vector 0x0000
     
+    #if (HOST_BUILD == TRUE)
+        host_restart();
+    #else
     __asm__ __volatile 
     (
        "ldi r30,0"  "\n\t"
        "ldi r31,0"  "\n\t"
        "icall" "\n\t"
      );
+    #endif
 }
 
 
@@ -53,21 +53,21 @@
    0x0D,        //  VID         520   8  M       Vendor ID (0x0D = DIY Decoder)
                                                 //        (0x3E = TAMS)
    0x80,        //  myAddrH     521   9  M       Decoder Adresse high (3 bits)
-   0,           //  cv522       522  10  -       reserved
-   0,           //  cv523       523  11  -       reserved
-   0,           //  cv524       524  12  -       reserved
-   0,           //  cv525       525  13  -       reserved
-   0,           //  cv526       526  14  -       reserved
-   0,           //  cv527       527  15  -       reserved
-   0,           //  cv528       528  16  -       reserved
-   0,           //  cv529       529  17  -       reserved
-   0,           //  cv530       530  18  -       reserved
-   0,           //  cv531       531  19  -       reserved
-   0,           //  cv532       532  20  -       reserved
-   0,           //  cv533       533  21  -       reserved
-   0,           //  cv534       534  22  -       reserved
-   0,           //  cv535       535  23  -       reserved
-   0,           //  cv536       536  24  -       reserved
+   2,           //  AddrRange   522  10  -       addresses used (2 for direct mode 3)
+   0,           //  FnAddrH     523  11  -       function decoder: loco address high (0 = short)
+   0,           //  FnAddrL     524  12  -       function decoder: loco address (0 = none)
+   0,           //  RxOkL       525  13  -       receiver health: accepted packets, low (RAM)
+   0,           //  RxOkH       526  14  -       receiver health: accepted packets, high
+   0,           //  RxXorL      527  15  -       receiver health: XOR errors, low
+   0,           //  RxXorH      528  16  -       receiver health: XOR errors, high
+   0,           //  RxOverL     529  17  -       receiver health: queue overruns, low
+   0,           //  RxOverH     530  18  -       receiver health: queue overruns, high
+   0,           //  RxSizeL     531  19  -       receiver health: oversize packets, low
+   0,           //  RxSizeH     532  20  -       receiver health: oversize packets, high
+   0,           //  RxPreL      533  21  -       receiver health: preamble aborts, low
+   0,           //  RxPreH      534  22  -       receiver health: preamble aborts, high
+   0,           //  RxSpikeL    535  23  -       receiver health: rejected spikes, low
+   0,           //  RxSpikeH    536  24  -       receiver health: rejected spikes, high
    0,           //  cv537       537  25  -       reserved
    0,           //  cv538       538  26  -       reserved
    0,           //  cv539       539  27  -       reserved
@@ -89,7 +89,8 @@
                                                // 01 = dual servo decoder
                                                // 02 = multiposition servo decoder
                                                // 03 = direct output control
-                                               // 04 = reserved
+                                               // 04 = dimmer
+                                               // 06 = light sequences
                                                // ...
                                                // 08 = dmx decoder
                                                // 16 = kirmes decoder
@@ -101,7 +102,8 @@
                                                // 01 = dual servo decoder
                                                // 02 = multiposition servo decoder
                                                // 03 = direct output control
-                                               // 04 = reserved
+                                               // 04 = dimmer
+                                               // 06 = light sequences
                                                // ...
                                                // 08 = dmx decoder
                                                // 16 = kirmes decoder
@@ -119,4 +121,11 @@
    1,           //  FBM_F3      549  37  -      feedback mode Func 3
    1,           //  FBM_F4      550  38  -      feedback mode Func 4
 
+#if (DIMMER_ENABLED)
+                //  Dim_Level   551  39  -      Dimmer: brightness of output 1..8 when on
+   { 255, 255, 255, 255, 128, 128, 64, 64 },
+                //  Dim_Rate    559  47  -      Dimmer: fade steps per 20ms, 0 = switch at once
+   { 4, 4, 4, 4, 2, 2, 0, 0 },
+#endif
+
 
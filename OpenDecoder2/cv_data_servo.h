@@ -53,21 +53,25 @@
    0x0D,        //  VID         520   8  M       Vendor ID (0x0D = DIY Decoder)
                                                 //        (0x3E = TAMS)
    0x80,        //  myAddrH     521   9  M       Decoder Adresse high (3 bits)
-   0,           //  cv522       522  10  -       reserved
-   0,           //  cv523       523  11  -       reserved
-   0,           //  cv524       524  12  -       reserved
-   0,           //  cv525       525  13  -       reserved
-   0,           //  cv526       526  14  -       reserved
-   0,           //  cv527       527  15  -       reserved
-   0,           //  cv528       528  16  -       reserved
-   0,           //  cv529       529  17  -       reserved
-   0,           //  cv530       530  18  -       reserved
-   0,           //  cv531       531  19  -       reserved
-   0,           //  cv532       532  20  -       reserved
-   0,           //  cv533       533  21  -       reserved
-   0,           //  cv534       534  22  -       reserved
-   0,           //  cv535       535  23  -       reserved
-   0,           //  cv536       536  24  -       reserved
+#if (SERVO_MUX)
+   3,           //  AddrRange   522  10  -       addresses used: servo 1..4, servo 5..8, adjust
+#else
+   1,           //  AddrRange   522  10  -       addresses used
+#endif
+   0,           //  FnAddrH     523  11  -       function decoder: loco address high (0 = short)
+   0,           //  FnAddrL     524  12  -       function decoder: loco address (0 = none)
+   0,           //  RxOkL       525  13  -       receiver health: accepted packets, low (RAM)
+   0,           //  RxOkH       526  14  -       receiver health: accepted packets, high
+   0,           //  RxXorL      527  15  -       receiver health: XOR errors, low
+   0,           //  RxXorH      528  16  -       receiver health: XOR errors, high
+   0,           //  RxOverL     529  17  -       receiver health: queue overruns, low
+   0,           //  RxOverH     530  18  -       receiver health: queue overruns, high
+   0,           //  RxSizeL     531  19  -       receiver health: oversize packets, low
+   0,           //  RxSizeH     532  20  -       receiver health: oversize packets, high
+   0,           //  RxPreL      533  21  -       receiver health: preamble aborts, low
+   0,           //  RxPreH      534  22  -       receiver health: preamble aborts, high
+   0,           //  RxSpikeL    535  23  -       receiver health: rejected spikes, low
+   0,           //  RxSpikeH    536  24  -       receiver health: rejected spikes, high
    0,           //  cv537       537  25  -       reserved
    0,           //  cv538       538  26  -       reserved
    0,           //  cv539       539  27  -       reserved
@@ -89,7 +93,8 @@
                                                // 01 = dual servo decoder
                                                // 02 = multiposition servo decoder
                                                // 03 = direct output control
-                                               // 04 = reserved
+                                               // 04 = dimmer
+                                               // 06 = light sequences
                                                // ...
                                                // 08 = dmx decoder
                                                // 16 = kirmes decoder
@@ -131,7 +136,7 @@
    6,           //  Sv1_TimeA   559  47  -      Servo 1 Curve Time stretch A
    8,           //  Sv1_CurveB  560  48  -      Servo 1 Curve Movement B
    6,           //  Sv1_TimeB   561  49  -      Servo 1 Curve Time stretch B
-   0,           //  Sv1_res     562  50  -      Servo 1 reserved
+   0,           //  Sv1_Frame   562  50  -      Servo 1 Frame: 0 = 20ms; 1 = SERVO_FRAME (5..10ms, if the servo allows)
 
    0,           //  Sv2_minL    563  51  -      Servo 2 Min low
    50,          //  Sv2_min     564  52  -      Servo 2 Min high
@@ -152,7 +157,7 @@
    8,           //  Sv2_TimeA   571  59  -      Servo 2 Curve Time stretch A
    8,           //  Sv2_CurveB  572  60  -      Servo 2 Curve Movement B
    8,           //  Sv2_TimeB   573  61  -      Servo 2 Curve Time stretch B
-   0,           //  Sv2_res     574  62  -      Servo 2 reserved
+   0,           //  Sv2_Frame   574  62  -      Servo 2 Frame: 0 = 20ms; 1 = SERVO_FRAME (5..10ms, if the servo allows)
 
    0,           //  cv575       575  63  -      reserved
 
@@ -186,14 +191,33 @@
    250,         //  Pos8_H      595  83  -      Servo 1 Position H, high part
 
 
-   0,           //  cv596       596  84  -      reserved
-   0,           //  cv597       597  85  -      reserved
-   0,           //  cv598       598  86  -      reserved
+// planned moves (curve 16, SERVO_PLAN), all servos; the time stretch (TimeA, TimeB)
+// of the servo divides the velocity
+
+   20,          //  Sv_Vmax     596  84  -      Servo max. velocity [us per 20ms]
+   16,          //  Sv_Amax     597  85  -      Servo max. acceleration [1/16 us per 20ms^2]
+   8,           //  Sv_Jmax     598  86  -      Servo max. jerk [1/64 us per 20ms^3]
    0,           //  cv599       599  87  -      reserved
 
+#if (SERVO_MUX)
+                //  Sv3_8       600  88  -      Servo 3..8, 12 CVs each like Servo 1:
+                //                              minL, min, maxL, max, Mode, Repeat, Loc,
+                //                              CurveA, TimeA, CurveB, TimeB, Frame
+   { 0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0,     // Servo 3
+     0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0,     // Servo 4
+     0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0,     // Servo 5
+     0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0,     // Servo 6
+     0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0,     // Servo 7
+     0, 50, 0, 200, (1 << CVbit_SvMode_ADJ), 0, 0, 7, 8, 8, 8, 0 },   // Servo 8
+#endif
+
+#if (DIMMER_ENABLED)
+                //  Dim_Level   600  88  -      Dimmer: brightness of output 1..8 when on
+   { 255, 255, 255, 255, 128, 128, 64, 64 },
+                //  Dim_Rate    608  96  -      Dimmer: fade steps per 20ms, 0 = switch at once
+   { 4, 4, 4, 4, 2, 2, 0, 0 },
+#endif
+
 
-//  servo_curve1[48] EEMEM;  // these are pairs of time/positions - see servo.c
-//  servo_curve2[48] EEMEM;
-//  servo_curve3[48] EEMEM;
-//  servo_curve4[48] EEMEM;
+//  servo_curves[192] EEMEM;  // directory and delta coded user curves - see servo.c
 
@@ -18,6 +18,18 @@
 //            2007-09-18 V0.2 kw CV554 bis CV559 ergnzt, damit TP File
 //                               und OpenDecoder3 konsistent (war vergessen) 
 //            2008-09-03 V0.3 kw CVbit_SvMode_PowCtrl dazu
+//            2026-10-17          CV522 (10) is AddrRange
+//            2026-10-17          CV523, CV524 (11, 12) are FnAddrH, FnAddrL
+//            2026-10-17          CV525..CV534 (13..22) are the receiver health
+//                               counters (read from RAM, see dcc_decode.c)
+//            2026-10-17          CV535, CV536 (23, 24): health, spikes
+//            2026-10-17          Dim_Level, Dim_Rate for the dimmer (mode 4)
+//            2026-10-17          Sv3_8 for the multiplexed servos (SERVO_MUX)
+//            2026-10-17          mode 6: light sequences (CV449..CV512,
+//                               outside of this record)
+//            2026-10-17          CV562, CV574 (50, 62) are Sv1_Frame, Sv2_Frame
+//            2026-10-17          CV596..CV598 (84..86) are Sv_Vmax, Sv_Amax, Sv_Jmax
+//            2026-10-17          AddrRange 0: all addresses from myAddr on
 //
 //------------------------------------------------------------------------
 //
@@ -73,21 +85,21 @@ typedef struct
     unsigned char version;     //519   7  M       Version
     unsigned char VID    ;     //520   8  M       Vendor ID (0x0D = DIY Decoder, 0x12 = JMRI, 0x3E = TAMS)
     unsigned char myAddrH;     //521   9  M       Decoder Adresse high (3 bits)
-    unsigned char cv522  ;     //522  10  -       reserved
-    unsigned char cv523    ;   //523  11  -       reserved
-    unsigned char cv524    ;   //524  12  -       reserved
-    unsigned char cv525    ;   //525  13  -       reserved
-    unsigned char cv526    ;   //526  14  -       reserved
-    unsigned char cv527    ;   //527  15  -       reserved
-    unsigned char cv528    ;   //528  16  -       reserved
-    unsigned char cv529    ;   //529  17  -       reserved
-    unsigned char cv530    ;   //530  18  -       reserved
-    unsigned char cv531    ;   //531  19  -       reserved
-    unsigned char cv532    ;   //532  20  -       reserved
-    unsigned char cv533    ;   //533  21  -       reserved
-    unsigned char cv534    ;   //534  22  -       reserved
-    unsigned char cv535    ;   //535  23  -       reserved
-    unsigned char cv536    ;   //536  24  -       reserved
+    unsigned char AddrRange;   //522  10  -       number of addresses used, from myAddr on (0 = all from myAddr on)
+    unsigned char FnAddrH;     //523  11  -       function decoder: loco address high (like CV17, 0 = short)
+    unsigned char FnAddrL;     //524  12  -       function decoder: loco address low / short address
+    unsigned char RxOkL    ;   //525  13  -       receiver health: accepted packets, low (RAM)
+    unsigned char RxOkH    ;   //526  14  -       receiver health: accepted packets, high
+    unsigned char RxXorL   ;   //527  15  -       receiver health: XOR errors, low
+    unsigned char RxXorH   ;   //528  16  -       receiver health: XOR errors, high
+    unsigned char RxOverL  ;   //529  17  -       receiver health: queue overruns, low
+    unsigned char RxOverH  ;   //530  18  -       receiver health: queue overruns, high
+    unsigned char RxSizeL  ;   //531  19  -       receiver health: oversize packets, low
+    unsigned char RxSizeH  ;   //532  20  -       receiver health: oversize packets, high
+    unsigned char RxPreL   ;   //533  21  -       receiver health: preamble aborts, low
+    unsigned char RxPreH   ;   //534  22  -       receiver health: preamble aborts, high
+    unsigned char RxSpikeL ;   //535  23  -       receiver health: rejected spikes, low
+    unsigned char RxSpikeH ;   //536  24  -       receiver health: rejected spikes, high
     unsigned char cv537    ;   //537  25  -       reserved
     unsigned char cv538    ;   //538  26  -       reserved
     unsigned char cv539    ;   //539  27  -       reserved
@@ -104,7 +116,8 @@ typedef struct
                                                                 // 01 = dual servo decoder
                                                                 // 02 = multiposition servo decoder
                                                                 // 03 = relais direct
-                                                                // 04 = reserved
+                                                                // 04 = dimmer (soft pwm, dimmer.c)
+                                                                // 06 = light sequences (sequence.c)
                                                                 // ...
                                                                 // 08 = dmx decoder
                                                                 // 10 = signal decoder (tbd.)
@@ -113,6 +126,7 @@ typedef struct
                                                                 // 32 = sodium
                                                                 // 33 = direct RGB-control
                                                                 // 34 = RGB-profiles + servo decoder
+                                                                // 48 = function decoder (loco address CV11/12)
 
     unsigned char FM ;         //546  34  -      global feedback mode
                                                                 // 00 = no feedback
@@ -141,7 +155,7 @@ typedef struct
     unsigned char Sv1_TimeA  ; //559  47  -      Servo 1 Curve Time stretch A
     unsigned char Sv1_CurveB ; //560  48  -      Servo 1 Curve Movement B
     unsigned char Sv1_TimeB  ; //561  49  -      Servo 1 Curve Time stretch B
-    unsigned char Sv1_res    ; //562  50  -      Servo 1 reserved
+    unsigned char Sv1_Frame  ; //562  50  -      Servo 1 Frame: 0=pulse every 20ms, 1=every SERVO_FRAME
 
     unsigned char Sv2_minL   ; //563  51  -      Servo 2 Min low
     unsigned char Sv2_min    ; //564  52  -      Servo 2 Min high
@@ -154,7 +168,7 @@ typedef struct
     unsigned char Sv2_TimeA  ; //571  59  -      Servo 2 Curve Time stretch A
     unsigned char Sv2_CurveB ; //572  60  -      Servo 2 Curve Movement B
     unsigned char Sv2_TimeB  ; //573  61  -      Servo 2 Curve Time stretch B
-    unsigned char Sv2_res    ; //574  62  -      Servo 2 reserved
+    unsigned char Sv2_Frame  ; //574  62  -      Servo 2 Frame: 0=pulse every 20ms, 1=every SERVO_FRAME
 
     unsigned char cv575      ; //575  63  -      reserved
 
@@ -188,11 +202,24 @@ typedef struct
     unsigned char Pos8_H     ; //595  ??  -      Servo 1 Position H, high part
 
 
-    unsigned char cv596      ; //596  ??  -      reserved
-    unsigned char cv597      ; //597  ??  -      reserved
-    unsigned char cv598      ; //598  ??  -      reserved
+    // planned moves (curve 16, SERVO_PLAN), all servos
+
+    unsigned char Sv_Vmax    ; //596  84  -      Servo max. velocity [us per 20ms]
+    unsigned char Sv_Amax    ; //597  85  -      Servo max. acceleration [1/16 us per 20ms^2]
+    unsigned char Sv_Jmax    ; //598  86  -      Servo max. jerk [1/64 us per 20ms^3]
     unsigned char cv599      ; //599  ??  -      reserved
 
+    #if (SERVO_MUX == TRUE)
+    unsigned char Sv3_8[6*12];   //600  88  -      Servo 3..8: 12 CVs each, like Servo 1 (551..562)
+                                 //                Servo 3: 600..611, Servo 4: 612..623 ... Servo 8: 660..671
+    #endif
+
+    #endif
+
+    #if (DIMMER_ENABLED == TRUE)
+    unsigned char Dim_Level[8];  //600  88  -      Dimmer: brightness of output 1..8 when on (1..255)
+                                 //                (after FBM_F4 without servo: 551  39)
+    unsigned char Dim_Rate[8];   //608  96  -      Dimmer: fade steps per 20ms, 0 = switch at once
     #endif
 
 
@@ -27,6 +27,25 @@
 //            2007-08-18 V0.6 kw masking of myADDRHigh with 0x7F
 //                               (hidden bit: unprogrammed)
 //            2007-11-22 V0.7 kw Decoder Reset added         
+//            2026-10-17          address and config are held in RAM
+//                               (my_decoder), reloaded after CV write
+//            2026-10-17          flush the eeprom cache before ACK and restart
+//            2026-10-17          RailCom: address to railcom.c, PoM answer
+//            2026-10-17          accessory formats by table, address window
+//                               (CV10); extended address fixed (AAA << 4)
+//            2026-10-17          repeated accessory commands are dropped
+//                               (DCC_DEDUP)
+//            2026-10-17          multifunction packets to the function
+//                               address (FUNCTION_ENABLED)
+//            2026-10-17          paged and physical register mode
+//            2026-10-17          receiver health counters as CV13..CV22
+//            2026-10-17          CV23/24: rejected spikes
+//            2026-10-17          address prefilter of the receiver loaded
+//                               with the context (DCC_PREFILTER)
+//            2026-10-17          CV449..CV512 are the light sequences
+//                               (EE_sequence, SEQUENCE_ENABLED)
+//            2026-10-17          CV10 = 0: no window, every address from
+//                               MyAddr on (decoders from before CV10)
 //
 // tests:     2007-04-14 decode okay
 //                       CV read/write direct mode okay, cv bitmode
@@ -35,7 +54,9 @@
 //
 // purpose:   flexible general purpose decoder for dcc
 //            here: all protocol issues with DCC
-//                   we support CV-byte operations and PoM
+//                   we support CV-byte operations and PoM,
+//                   service mode direct, paged and physical register
+//                   CV13..CV24 are the receiver health counters (RAM)
 //                   we do CV remapping - CV1 == CV513 and so on
 //
 // content:   A DCC-Decoder for ATmega8515/ATmega162 and other AVR
@@ -63,6 +84,8 @@
 #include "hardware.h"            // port definitions
 #include "dcc_receiver.h"        // receiver for dcc
 #include "dcc_decode.h"          // decoder for dcc
+#include "railcom.h"             // answers in the cutout
+#include "sequence.h"            // CV range of the light sequences
 
 
 #define SERVICE_MODE_TIMEOUT   40000L    // 40ms - at least 20ms
@@ -104,13 +127,11 @@
 // (Note: this is not really clean - but we are on micro and have to save memory ...)
 //
 
-unsigned int  ReceivedAddr;         // last received address - gets filled by dcc_decode
-unsigned int  ReceivedCommand;      // format: 0000dddd dddddccc
+t_received received;                // last decoded packet, see dcc_decode.h
+                                    // command: 0000dddd dddddccc
                                     // where: ccc is the coil address like in DCC.
-                                    // ddddddddd is the difference between ReceivedAddr
-                                    // and MyAddr (only in case ReceivedAddr > MyAddr) 
-unsigned char ReceivedActivate;     // 0: a turn OFF was received
-                                    // !0: a turn ON was received (typ. 0b00001000)
+                                    // dddddddd is the position of addr in our window
+                                    // (addr - MyAddr)
 
 
 
@@ -140,15 +161,101 @@ unsigned char service_mode_state;   // bit field
                           
 signed char last_sm_mode_received;  // timer variable to create a update grid;
 
+unsigned char sm_page = 1;          // page register (paged mode)
+#define SM_PAGE_REGISTER  0xFFFF    // ReceivedCV for the page register
+
+
+// copy of the CVs used for every accessory message - this saves the eeprom
+// reads in analyze_message(); must be reloaded after any change of these CVs.
+
+struct
+  {
+    unsigned char extended;         // CV.Config Bit 6: 0=basic, !0=extended accessory
+    unsigned int  basic_addr;       // MyAddr for basic accessory (9 bit)
+    unsigned int  ext_addr;         // MyAddr for extended accessory (11 bit)
+    unsigned char window;           // number of addresses, starting at MyAddr (CV.AddrRange),
+                                    // 0: all addresses from MyAddr on (as before CV10)
+    #if (FUNCTION_ENABLED == TRUE)
+    unsigned int  fn_addr;          // loco address of the function decoder, 0 = none
+    unsigned char fn_long;          // fn_addr is a long (14 bit) address
+    #endif
+  } my_decoder;
+
+#if (DCC_PREFILTER == TRUE)
+
+// first bytes of the packets which may be for us, see dcc_prefilter()
+static void prefilter_load(void)
+  {
+    unsigned char acc[8];
+    unsigned char i, a, count, sreg;
+    unsigned char loco0 = 0, loco1 = 0, loco_long = 0;
+
+    memset(acc, 0, sizeof(acc));
+    count = my_decoder.window;
+    if (count == 0) memset(acc, 0xFF, sizeof(acc));    // no window: every address
+    #if (DEBUG_FEEDBACK == TRUE)
+        if (count < 255) count++;               // my_addr + 1 is remapped
+    #endif
+    for (i=0; i<count; i++)
+      {
+        if (my_decoder.extended) a = ((my_decoder.ext_addr + i) >> 2) & 0x3F;
+        else                     a = (my_decoder.basic_addr + i) & 0x3F;
+        acc[a >> 3] |= 1 << (a & 0x07);
+      }
+    acc[7] |= 0x80;                             // 0x3F: broadcast 0x1FF / 0x7FF
+
+    #if (FUNCTION_ENABLED == TRUE)
+        if (my_decoder.fn_long)
+          {
+            loco0 = 0xC0 | (my_decoder.fn_addr >> 8);
+            loco1 = my_decoder.fn_addr & 0xFF;
+            loco_long = 1;
+          }
+        else loco0 = my_decoder.fn_addr;        // 0: none
+    #endif
+
+    sreg = SREG;                                // also called before sei()
+    cli();
+    memcpy((void *)dcc_filter.acc, acc, sizeof(acc));
+    dcc_filter.loco0 = loco0;
+    dcc_filter.loco1 = loco1;
+    dcc_filter.loco_long = loco_long;
+    SREG = sreg;
+  }
+
+#endif // (DCC_PREFILTER == TRUE)
+
+void load_decoder_context(void)
+  {
+    unsigned char addr_h, addr_l;
+
+    addr_h = my_eeprom_read_byte(&CV.myAddrH) & 0x7F;   // without hidden bit 'unprogrammed'
+    addr_l = my_eeprom_read_byte(&CV.myAddrL);
+
+    my_decoder.extended = my_eeprom_read_byte(&CV.Config) & (1<<6);
+    my_decoder.basic_addr = (addr_h << 6) | addr_l;
+    my_decoder.ext_addr = ((addr_h << 8) | addr_l) - 1;
+    my_decoder.window = my_eeprom_read_byte(&CV.AddrRange);
+
+    #if (FUNCTION_ENABLED == TRUE)
+        addr_h = my_eeprom_read_byte(&CV.FnAddrH);          // like CV17/18: 0 = short address
+        addr_l = my_eeprom_read_byte(&CV.FnAddrL);
+        my_decoder.fn_long = (addr_h != 0);
+        my_decoder.fn_addr = ((addr_h & 0x3F) << 8) | addr_l;
+        if (!my_decoder.fn_long && (addr_l > 127)) my_decoder.fn_addr = 0;
+    #endif
+
+    #if (RAILCOM_ENABLED == TRUE)
+        railcom_load(my_decoder.extended ? my_decoder.ext_addr : my_decoder.basic_addr,
+                     my_decoder.extended,
+                     my_eeprom_read_byte(&CV.BiDi));
+    #endif
+
+    #if (DCC_PREFILTER == TRUE)
+        prefilter_load();
+    #endif
+  }
 
-void activate_ACK(unsigned char time)
-{
-	unsigned char i;
-	// set ACK for  time [ms]
-	DCC_ACK_ON;
-	for (i=0; i<time; i++) _mydelay_us(1000);
-	DCC_ACK_OFF;
-}
 
 //==============================================================================
 //
@@ -191,7 +298,7 @@ void ResetDecoder(unsigned char state)
         eeptr++;
         pgmptr++;
       }
-    eeprom_busy_wait();
+    my_eeprom_flush();
     LED_OFF;
   }
 
@@ -200,14 +307,89 @@ unsigned char cv_is_blocked(unsigned int cv)
 // some CV are not allowed to be written
 // block access to: CV519, CV520 (=7,8) (Version and VID)
 //                  CV540, CV541 (=28,29) (config)
+//                  (CV28 is free with RailCom)
   {
     if (cv == (7-1)) return(TRUE);
     if (cv == (8-1)) return(TRUE);       // cv8 is coded as 7
+    #if (RAILCOM_ENABLED == FALSE)
     if (cv == (28-1)) return(TRUE);
+    #endif
     if (cv == (29-1)) return(TRUE);
     return(FALSE);
   }
 
+//---------------------------------------------------------------------------------------
+// receiver health (DCC_HEALTH): CV13..CV22 are not read from eeprom, but
+// from dcc_health, low byte first:
+//   CV13/14 accepted, CV15/16 xor_error, CV17/18 overrun,
+//   CV19/20 oversize, CV21/22 preamble_abort, CV23/24 spike
+// a write of any value to one of them clears all counters.
+
+#define HEALTH_CV_FIRST   (13-1)
+#define HEALTH_CV_LAST    (24-1)
+
+#if (DCC_HEALTH == TRUE)
+static unsigned char cv_is_health(unsigned int cv)
+  {
+    return((cv >= HEALTH_CV_FIRST) && (cv <= HEALTH_CV_LAST));
+  }
+
+static void health_clear(void)
+  {
+    cli();
+    memset((void *)&dcc_health, 0, sizeof(dcc_health));
+    sei();
+  }
+#endif
+
+//---------------------------------------------------------------------------------------
+// light sequences (SEQUENCE_ENABLED): CV449..CV512 are EE_sequence, outside
+// of the CV record; after a write the sequencer reloads its copy.
+
+#if (SEQUENCE_ENABLED == TRUE)
+static unsigned char cv_is_sequence(unsigned int cv)
+  {
+    return((cv >= SEQ_CV_FIRST) && (cv <= SEQ_CV_LAST));
+  }
+#endif
+
+// value of a CV (index as ReceivedCV)
+static unsigned char cv_read(unsigned int cv)
+  {
+    #if (SEQUENCE_ENABLED == TRUE)
+    if (cv_is_sequence(cv)) return(my_eeprom_read_byte(&EE_sequence[cv - SEQ_CV_FIRST]));
+    #endif
+    #if (DCC_HEALTH == TRUE)
+    if (cv_is_health(cv))
+      {
+        unsigned int counter;
+        cli();                                  // 16 bit, changed by ISR
+        counter = ((volatile unsigned int *)&dcc_health)[(cv - HEALTH_CV_FIRST) / 2];
+        sei();
+        if ((cv - HEALTH_CV_FIRST) & 1) return(counter >> 8);
+        return(counter);
+      }
+    #endif
+    return(my_eeprom_read_byte(&CV.myAddrL + cv));
+  }
+
+// write a CV and wait until it is in the eeprom (index as ReceivedCV)
+static void cv_write(unsigned int cv, unsigned char data)
+  {
+    #if (SEQUENCE_ENABLED == TRUE)
+    if (cv_is_sequence(cv))
+      {
+        my_eeprom_write_byte(&EE_sequence[cv - SEQ_CV_FIRST], data);
+        my_eeprom_flush();
+        sequence_load();
+        return;
+      }
+    #endif
+    my_eeprom_write_byte(&CV.myAddrL + cv, data);
+    my_eeprom_flush();                          // ACK only when really written
+    load_decoder_context();
+  }
+
 // used static: 
 //   ReceivedOperation
 //   ReceivedCV
@@ -227,7 +409,7 @@ void cv_operation(void)
         case CV_NOP:
             break;
         case CV_VERIFY:
-            if (my_eeprom_read_byte(&CV.myAddrL + ReceivedCV) == ReceivedData)
+            if (cv_read(ReceivedCV) == ReceivedData)
               {
                 activate_ACK(6);
               }
@@ -237,11 +419,19 @@ void cv_operation(void)
               {
                 activate_ACK(6);
                 ResetDecoder(ReceivedData);
+                wait_ACK();
                 _restart();                         // really hard exit
               }
+            #if (DCC_HEALTH == TRUE)
+            if (cv_is_health(ReceivedCV))
+              {
+                health_clear();
+                activate_ACK(6);
+                break;
+              }
+            #endif
             if (cv_is_blocked(ReceivedCV)) return;
-            my_eeprom_write_byte(&CV.myAddrL + ReceivedCV, ReceivedData);
-            eeprom_busy_wait();
+            cv_write(ReceivedCV, ReceivedData);
             activate_ACK(6);
             break;
         case CV_BITOPERATION:
@@ -255,26 +445,33 @@ void cv_operation(void)
               { // write bit
                 unsigned char oldbyte;
 
+                #if (DCC_HEALTH == TRUE)
+                if (cv_is_health(ReceivedCV))
+                  {
+                    health_clear();
+                    activate_ACK(6);
+                    break;
+                  }
+                #endif
                 if (cv_is_blocked(ReceivedCV)) return;
 
-                oldbyte = my_eeprom_read_byte(&CV.myAddrL + ReceivedCV);
+                oldbyte = cv_read(ReceivedCV);
                 if (ReceivedData & 0b00001000) oldbyte |= bitmask;
                 else                           oldbyte &= ~bitmask;
                 
-                my_eeprom_write_byte(&CV.myAddrL + ReceivedCV, oldbyte);
-                eeprom_busy_wait();
+                cv_write(ReceivedCV, oldbyte);
                 activate_ACK(6);
               }
             else
               { // verify bit
                 if (ReceivedData & 0b00001000)
                   {
-                    if (my_eeprom_read_byte(&CV.myAddrL + ReceivedCV) & bitmask) 
+                    if (cv_read(ReceivedCV) & bitmask) 
                         activate_ACK(6);
                   }
                 else
                   {
-                    if ((my_eeprom_read_byte(&CV.myAddrL + ReceivedCV) & bitmask) == 0)
+                    if ((cv_read(ReceivedCV) & bitmask) == 0)
                         activate_ACK(6);
                   }
               }
@@ -283,6 +480,344 @@ void cv_operation(void)
   }
 
 
+//---------------------------------------------------------------------------------------
+// service mode: the page register (register 6 in paged/register mode)
+
+static void page_operation(void)
+  {
+    if (ReceivedOperation == CV_WRITE)
+      {
+        sm_page = ReceivedData;
+        activate_ACK(6);
+      }
+    else if (ReceivedOperation == CV_VERIFY)
+      {
+        if (sm_page == ReceivedData) activate_ACK(6);
+      }
+  }
+
+// all service mode commands are executed after two identical packets
+static void sm_command(unsigned char operation, unsigned int cv, unsigned char data)
+  {
+    if (service_mode_state & (1 << SM_RECEIVED))
+      {  // this is the second message
+        if ( (operation == ReceivedOperation) &&
+             (cv == ReceivedCV) &&
+             (data == ReceivedData)  )
+          {
+            if (cv == SM_PAGE_REGISTER) page_operation();
+            else                        cv_operation();
+          }
+        service_mode_state &= ~(1 << SM_RECEIVED);
+      }
+    else
+      {
+        service_mode_state |= (1 << SM_RECEIVED);   // we have a sm message
+        ReceivedOperation = operation;
+        ReceivedCV = cv;
+        ReceivedData = data;
+      }
+  }
+
+
+//---------------------------------------------------------------------------------------
+// dedup of repeated accessory commands
+//
+// Command stations send each accessory command 3..8 times. The last command
+// of an address is kept with its time; the same command to this address
+// within DEDUP_TIME is a repeat and is dropped (its time is refreshed).
+// Any other command to the address replaces the entry - so on, off, on
+// are all passed.
+
+#if (DCC_DEDUP == TRUE)
+
+#define DEDUP_SIZE      4                           // addresses
+#define DEDUP_TIME      (500000L / TICK_PERIOD)     // max. gap of repeats
+#define DEDUP_FREE      0xFFFF                      // key of an unused entry
+
+#if (DEDUP_TIME > 100)
+  #error: DEDUP_TIME too large for timerval
+#endif
+
+static struct
+  {
+    unsigned int  key;                  // address, bit 15: extended
+    unsigned char value;                // basic: CDDD, extended: aspect
+    unsigned char time;                 // timerval of the last copy
+  } dedup[DEDUP_SIZE];
+
+static unsigned char dedup_sweep;       // timerval of the last aging
+
+t_dedup_stat dedup_stat;
+
+static void init_dedup(void)
+  {
+    unsigned char i;
+
+    for (i=0; i<DEDUP_SIZE; i++) dedup[i].key = DEDUP_FREE;
+    dedup_sweep = timerval;
+  }
+
+// free old entries; called from the main loop and for every packet
+// (once per tick), so no entry survives a wrap of timerval.
+void dedup_age(void)
+  {
+    unsigned char i, now = timerval;
+
+    if (now == dedup_sweep) return;
+    dedup_sweep = now;
+    for (i=0; i<DEDUP_SIZE; i++)
+      {
+        if ((unsigned char)(now - dedup[i].time) >= DEDUP_TIME) dedup[i].key = DEDUP_FREE;
+      }
+  }
+
+// returns TRUE if this is a repeat
+static unsigned char dedup_repeat(unsigned int key, unsigned char value)
+  {
+    unsigned char i, slot = 0, oldest = 0, age;
+    unsigned char now = timerval;
+
+    for (i=0; i<DEDUP_SIZE; i++)
+      {
+        if (dedup[i].key == key)
+          {
+            age = now - dedup[i].time;
+            dedup[i].time = now;
+            if ((dedup[i].value == value) && (age < DEDUP_TIME))
+              {
+                dedup_stat.hits++;
+                return(TRUE);
+              }
+            dedup[i].value = value;
+            dedup_stat.misses++;
+            return(FALSE);
+          }
+        age = (dedup[i].key == DEDUP_FREE) ? 255 : (unsigned char)(now - dedup[i].time);
+        if (age >= oldest)
+          {
+            oldest = age;
+            slot = i;
+          }
+      }
+    dedup[slot].key = key;                  // replace free or oldest entry
+    dedup[slot].value = value;
+    dedup[slot].time = now;
+    dedup_stat.misses++;
+    return(FALSE);
+  }
+
+#endif // (DCC_DEDUP == TRUE)
+
+
+//---------------------------------------------------------------------------------------
+// accessory formats (RCN-213), identified by the second byte and the size (incl. XOR):
+//
+//   basic            10AAAAAA 1AAACDDD                                   size 3
+//   basic PoM        10AAAAAA 1AAACDDD 1110CCVV VVVVVVVV DDDDDDDD        size 6
+//   extended         10AAAAAA 0AAA0AA1 000XXXXX                          size 4
+//   extended PoM     10AAAAAA 0AAA0AA1 1110CCVV VVVVVVVV DDDDDDDD        size 6
+//
+// AAA in the second byte are the high address bits, inverted.
+// The address is then checked with one compare against our window
+// [MyAddr ... MyAddr + CV.AddrRange - 1]; basic 0x1FF and extended 0x7FF are broadcasts.
+// CV.AddrRange = 0 (the value of decoders from before CV10) accepts every address
+// from MyAddr on, like these versions did.
+
+typedef struct
+  {
+    unsigned char mask;             // applied to dcc[1]
+    unsigned char match;
+    unsigned char size;
+    unsigned char type;             // RX_x
+  } t_acc_format;
+
+static const t_acc_format acc_format[] PROGMEM =
+  {
+    { 0b10000000, 0b10000000, 3, RX_ACC },
+    { 0b10000000, 0b10000000, 6, RX_ACC | RX_POM },
+    { 0b10001001, 0b00000001, 4, RX_ACC | RX_EXT },
+    { 0b10001001, 0b00000001, 6, RX_ACC | RX_EXT | RX_POM },
+  };
+
+#define ACC_FORMATS  (sizeof(acc_format) / sizeof(acc_format[0]))
+
+static unsigned char analyze_accessory(t_message *new_dcc)
+  {
+    unsigned char i, type, coil, shift, value;
+    unsigned int my_addr, broadcast, index;
+
+    for (i=0; i<ACC_FORMATS; i++)
+      {
+        if (((new_dcc->dcc[1] & pgm_read_byte(&acc_format[i].mask)) == pgm_read_byte(&acc_format[i].match))
+          && (new_dcc->size == pgm_read_byte(&acc_format[i].size))) break;
+      }
+    if (i == ACC_FORMATS) return(0);                        // unknown format
+
+    type = pgm_read_byte(&acc_format[i].type);
+    if (((type & RX_EXT) != 0) != (my_decoder.extended != 0)) return(0);   // not our mode
+
+    if (type & RX_EXT)
+      {
+        received.addr = ((new_dcc->dcc[1] & 0b00000110) >> 1)
+                      | ((new_dcc->dcc[0] & 0b00111111) << 2)
+                      | ((~new_dcc->dcc[1] & 0b01110000) << 4);
+        received.activate = 0b00001000;
+        coil = new_dcc->dcc[2] & 0b00011111;                // aspect
+        value = coil;
+        shift = 5;
+        my_addr = my_decoder.ext_addr;
+        broadcast = 0x07FF;
+      }
+    else
+      {
+        received.addr = (new_dcc->dcc[0] & 0b00111111)
+                      | ((~new_dcc->dcc[1] & 0b01110000) << 2);
+        received.activate = new_dcc->dcc[1] & 0b00001000;
+        coil = new_dcc->dcc[1] & 0b00000111;
+        value = new_dcc->dcc[1] & 0b00001111;               // CDDD
+        shift = 3;
+        my_addr = my_decoder.basic_addr;
+        broadcast = 0x01FF;
+      }
+
+    received.index = 0;
+    received.command = coil;
+
+    if (type & RX_POM)
+      {
+        received.type = type;
+        if (received.addr != my_addr) return(0);
+
+        ReceivedOperation = (new_dcc->dcc[2] & 0b00001100) >> 2;    // CC bits
+        ReceivedCV = ((new_dcc->dcc[2] & 0b00000011) << 8)
+                   | new_dcc->dcc[3];
+        ReceivedData = new_dcc->dcc[4];
+
+        cv_operation();                         // note: this is not fully correct,
+                                                // we react on the first PoM-command, not on the second
+        #if (RAILCOM_ENABLED == TRUE)
+            railcom_pom(cv_read(ReceivedCV));
+        #endif
+        return(0);
+      }
+
+    if (received.addr == broadcast)
+      {
+        received.type = type | RX_BROADCAST;
+        #if (DCC_DEDUP == TRUE)
+            if (dedup_repeat(received.addr | ((type & RX_EXT) ? 0x8000 : 0), value)) return(0);
+        #endif
+        return(2);
+      }
+    received.type = type;
+
+    #if (DEBUG_FEEDBACK == TRUE)
+        if (!(type & RX_EXT) && (received.addr == my_addr + 1))
+          {
+            received.activate = 0;              // remap this to the off command! (dirty!)
+            return(2);
+          }
+    #endif
+
+    if (received.addr < my_addr) return(1);
+    index = received.addr - my_addr;
+    if (my_decoder.window && (index >= my_decoder.window)) return(1);  // 0: no upper limit
+
+    received.index = index;
+    received.command = (index << shift) | coil;
+    #if (DCC_DEDUP == TRUE)
+        if (dedup_repeat(received.addr | ((type & RX_EXT) ? 0x8000 : 0), value)) return(0);
+    #endif
+    if (index) return(3);
+    return(2);
+  }
+
+
+#if (FUNCTION_ENABLED == TRUE)
+
+//---------------------------------------------------------------------------------------
+// multifunction instructions (RCN-212) to our function address; see RP921
+//
+// instr: first instruction byte, len: bytes up to the XOR
+// returns 4 if 'loco' has changed, else 0
+
+t_loco loco;
+
+static unsigned char analyze_loco(unsigned char *instr, unsigned char len)
+  {
+    unsigned long functions = loco.functions;
+    unsigned char speed = loco.speed;
+    unsigned char step;
+
+    received.type = RX_LOCO;
+    if (len == 0) return(0);
+
+    switch (instr[0] & 0b11100000)
+      {
+        case 0b00000000:            // 000 Decoder and Consist Control Instruction
+            return(0);
+        case 0b00100000:            // 001 Advanced Operation Instructions
+            if ((instr[0] != 0b00111111) || (len < 2)) return(0);
+            speed = instr[1] & 0x7F;                        // 128 speed steps
+            if (instr[1] & 0x80) functions |= (1UL << FN_BIT_FORWARD);
+            else                 functions &= ~(1UL << FN_BIT_FORWARD);
+            break;
+        case 0b01000000:            // 010 Speed and Direction Instruction for reverse operation
+        case 0b01100000:            // 011 Speed and Direction Instruction for forward operation
+            step = ((instr[0] & 0x0F) << 1) | ((instr[0] >> 4) & 0x01);    // 28 steps: C is lsb
+            if (step < 2)      speed = 0;                   // stop
+            else if (step < 4) speed = 1;                   // emergency stop
+            else               speed = (step - 3) * 9 / 2 + 1;     // 1..28 -> 5..127
+            if (instr[0] & 0b00100000) functions |= (1UL << FN_BIT_FORWARD);
+            else                       functions &= ~(1UL << FN_BIT_FORWARD);
+            break;
+        case 0b10000000:            // 100 Function Group One Instruction: 100 F0 F4 F3 F2 F1
+            functions &= ~0x1FUL;
+            functions |= ((instr[0] & 0x0F) << 1) | ((instr[0] >> 4) & 0x01);
+            break;
+        case 0b10100000:            // 101 Function Group Two Instruction
+            if (instr[0] & 0b00010000)
+              {                                             // 1011: F8..F5
+                functions &= ~(0x0FUL << 5);
+                functions |= (unsigned long)(instr[0] & 0x0F) << 5;
+              }
+            else
+              {                                             // 1010: F12..F9
+                functions &= ~(0x0FUL << 9);
+                functions |= (unsigned long)(instr[0] & 0x0F) << 9;
+              }
+            break;
+        case 0b11000000:            // 110 Future Expansion: F13..F28
+            if (len < 2) return(0);
+            if (instr[0] == 0b11011110)
+              {
+                functions &= ~(0xFFUL << 13);
+                functions |= (unsigned long)instr[1] << 13;
+              }
+            else if (instr[0] == 0b11011111)
+              {
+                functions &= ~(0xFFUL << 21);
+                functions |= (unsigned long)instr[1] << 21;
+              }
+            else return(0);
+            break;
+        case 0b11100000:            // 111 Configuration Variable Access Instruction
+            return(0);
+      }
+
+    if (speed > 1) functions |= (1UL << FN_BIT_MOVING);
+    else           functions &= ~(1UL << FN_BIT_MOVING);
+
+    if ((functions == loco.functions) && (speed == loco.speed)) return(0);   // refresh
+    loco.functions = functions;
+    loco.speed = speed;
+    return(4);
+  }
+
+#endif // (FUNCTION_ENABLED == TRUE)
+
+
 //
 //---------------------------------------------------------------------------------------
 // analyze_message(struct message *new_dcc) checks the received DCC message
@@ -290,17 +825,17 @@ void cv_operation(void)
 //      pointer to struct of message, containing size and dcc data (supplied by the dcc_receiver)
 //
 // returns:
-//       0: if void,
+//       0: if void (also a repeat of the last command to this address)
 //       1: if accessory command and command type equal our mode
 //       2: if accessory command and address equal myAddr (or broadcast)
-//       3: if accessory command and address > myAddr (Received Command is extended)
+//       3: if accessory command and address in our window, but > myAddr
+//          (received.command is extended)
+//       4: if loco packet to our function address changed 'loco'
 //
 // side effects: 
 //       a) accesses to CV are handled here.
 //       b) Globals are loaded:
-//              ReceivedAddress
-//              ReceivedCommand
-//              ReceivedActivate
+//              received
 //       c) Local Statics are loaded:
 //              ReceivedOperation
 //              ReceivedCV
@@ -308,12 +843,10 @@ void cv_operation(void)
 //
 unsigned char analyze_message(t_message *new_dcc)
   {
+    #if (DCC_PREFILTER == FALSE)                        // else: done by the receiver
     unsigned char i;
     unsigned char myxor = 0;
-    unsigned int MyAddr;
-    unsigned char MyConfig;
 
-  
     for (i=0; i<new_dcc->size; i++)
       {
         myxor = myxor ^ new_dcc->dcc[i];
@@ -321,14 +854,24 @@ unsigned char analyze_message(t_message *new_dcc)
     if (myxor)
       {
         // checksum error, ignore
+        DCC_HEALTH_INC(xor_error);
         return(0);
       }
+    DCC_HEALTH_INC(accepted);
+    #endif
+
+    #if (DCC_DEDUP == TRUE)
+        dedup_age();
+    #endif
 
     if (service_mode_state & (1 << SM_ENABLED))
       {                                                 //// we are in Service Mode!
         if ((char)(timerval - last_sm_mode_received) >= (SERVICE_MODE_TIMEOUT / TICK_PERIOD)) 
           {
             service_mode_state = 0;                    // timeout reached, leave service mode
+            #if (DCC_PREFILTER == TRUE)
+                dcc_filter.open &= ~(1 << FILTER_SM);
+            #endif
             #if (DEBUG_PORTB7_IS_SM == TRUE)
                 PORTB &= ~(1<<7);
             #endif
@@ -339,6 +882,9 @@ unsigned char analyze_message(t_message *new_dcc)
             if (new_dcc->dcc[1] == 0)
               { // reset message - enter service mode
                 service_mode_state = (1 << SM_ENABLED);
+                #if (DCC_PREFILTER == TRUE)
+                    dcc_filter.open |= (1 << FILTER_SM);
+                #endif
                 #if (DEBUG_PORTB7_IS_SM == TRUE)
                     PORTB |= (1<<7);
                 #endif
@@ -361,38 +907,14 @@ unsigned char analyze_message(t_message *new_dcc)
                 // {preamble} 0 0111CCAA 0 AAAAAAAA 0 111KDBBB 0 EEEEEEEE 1
                 //  K = (1=write, 0=verify) D = Bitvalue, BBB = bitpos
             
-                if (service_mode_state & (1 << SM_RECEIVED))
-                  {  // this is the second message
-                    unsigned int tempi;
-                    unsigned char tempc;
-                    tempc = (new_dcc->dcc[0] & 0b00001100);// CC bits
-                    tempc = tempc >> 2; // CC bits
-
-                    tempi = ((new_dcc->dcc[0] & 0b00000011) << 8)
-                               | new_dcc->dcc[1];
-
-                    if ( (tempc == ReceivedOperation) &&
-                         (tempi == ReceivedCV) &&
-                         (new_dcc->dcc[2] == ReceivedData)  )
-                      {
-                        cv_operation();
-                      }
-           
-                    service_mode_state &= ~(1 << SM_RECEIVED);
-                  }
-                else
-                  {
-                    service_mode_state |= (1 << SM_RECEIVED);   // we have a sm message
-                    
-                    ReceivedOperation = (new_dcc->dcc[0] & 0b00001100);  // CC bits
-                    ReceivedOperation = ReceivedOperation >> 2;     // CC bits
-                    ReceivedCV = ((new_dcc->dcc[0] & 0b00000011) << 8)
-                                | new_dcc->dcc[1];
-                    ReceivedData = new_dcc->dcc[2];
-                  }
+                sm_command((new_dcc->dcc[0] & 0b00001100) >> 2,     // CC bits
+                           ((new_dcc->dcc[0] & 0b00000011) << 8) | new_dcc->dcc[1],
+                           new_dcc->dcc[2]);
               }
             if (new_dcc->size == 3) // paged/register mode
               {
+                unsigned int cv;
+
                 service_mode_state |= (1 << SM_ENABLED);
                 #if (DEBUG_PORTB7_IS_SM == TRUE)
                     PORTB |= (1<<7);
@@ -403,9 +925,36 @@ unsigned char analyze_message(t_message *new_dcc)
                 // {preamble} 0 0111CRRR 0 DDDDDDDD 0 EEEEEEEE 1
                 // C = 1: write
                 // C = 0: verify
-                // RRR = Register
-                
-                // !!!! Note: this is not supported !!!!
+                // RRR = Register - 1
+                //
+                // register 1..4: paged: CV (page-1)*4 + 1..4
+                //                physical: CV1..CV4 (page is 1)
+                // register 5:    CV29
+                // register 6:    page register
+                // register 7, 8: CV7, CV8
+
+                switch(new_dcc->dcc[0] & 0b00000111)
+                  {
+                    default:
+                        cv = (unsigned int)(unsigned char)(sm_page - 1) * 4
+                           + (new_dcc->dcc[0] & 0b00000011);
+                        break;
+                    case 4:
+                        cv = 29-1;
+                        break;
+                    case 5:
+                        cv = SM_PAGE_REGISTER;
+                        break;
+                    case 6:
+                        cv = 7-1;
+                        break;
+                    case 7:
+                        cv = 8-1;                   // cv8 is coded as 7
+                        break;
+                  }
+                sm_command((new_dcc->dcc[0] & 0b00001000) ? CV_WRITE : CV_VERIFY,
+                           cv,
+                           new_dcc->dcc[1]);
               }
             return(0);
           }
@@ -417,6 +966,9 @@ unsigned char analyze_message(t_message *new_dcc)
       }
 
     service_mode_state = 0;       // anyway
+    #if (DCC_PREFILTER == TRUE)
+        dcc_filter.open &= ~(1 << FILTER_SM);
+    #endif
     #if (DEBUG_PORTB7_IS_SM == TRUE)
         PORTB &= ~(1<<7);
     #endif
@@ -425,6 +977,10 @@ unsigned char analyze_message(t_message *new_dcc)
         if (new_dcc->dcc[1] == 0)
           {
             service_mode_state |= (1 << SM_ENABLED);
+            sm_page = 1;                                // paged mode starts at page 1
+            #if (DCC_PREFILTER == TRUE)
+                dcc_filter.open |= (1 << FILTER_SM);    // all packets to main
+            #endif
                  
             #if (DEBUG_PORTB7_IS_SM == TRUE)
                 PORTB |= (1<<7);
@@ -438,153 +994,33 @@ unsigned char analyze_message(t_message *new_dcc)
         // C may be lsb of speed or headlight
         // D = direction: 1 = forward
 
-        ReceivedAddr = (new_dcc->dcc[0] & 0b01111111);
-
-        // see RP921 for more information
-
-        switch (new_dcc->dcc[1] & 0b11100000)
-          {
-            case 0b00000000:            // 000 Decoder and Consist Control Instruction
-            case 0b00100000:            // 001 Advanced Operation Instructions
-            case 0b01000000:            // 010 Speed and Direction Instruction for reverse operation
-            case 0b01100000:            // 011 Speed and Direction Instruction for forward operation
-            case 0b10000000:            // 100 Function Group One Instruction
-            case 0b10100000:            // 101 Function Group Two Instruction
-            case 0b11000000:            // 110 Future Expansion
-            case 0b11100000:            // 111 Configuration Variable Access Instruction
-                break;
-          }                                       
-      }
-    else if (new_dcc->dcc[0] <= 191)
-      {                                                         //// Accessory 
-        MyConfig = my_eeprom_read_byte(&CV.Config) & (1<<6);       // (0=basic, 1=extended)
-
-        if ((new_dcc->dcc[1] >= 0b10000000) && (MyConfig == 0))
-          {                                                     //// Basic Accessory (9 bit addr)
-            
-            // take bits 5 4 3 2 1 0 from new_dcc->dcc[0]
-            // take Bits 6 5 4 from new_dcc->dcc[1] and invert
-
-            ReceivedAddr = (new_dcc->dcc[0] & 0b00111111)
-                        | ((~new_dcc->dcc[1] & 0b01110000) << 2);
-
-            MyAddr = ((my_eeprom_read_byte(&CV.myAddrH) & 0x7F) << 6) |
-                    (my_eeprom_read_byte(&CV.myAddrL));
-
-            ReceivedActivate = new_dcc->dcc[1] & 0b00001000;
-            ReceivedCommand = new_dcc->dcc[1] & 0b00000111;
-            if (ReceivedAddr > MyAddr)
-              {
-                ReceivedCommand += (ReceivedAddr - MyAddr) * 8;   // for more than one addr
-              }
-            
-            if (new_dcc->size == 3) // it's a command
-              {
-                // Format:
-                // {preamble} 0 10AAAAAA 0 1AAACDDD 0 EEEEEEEE 1
-                //                AAAAAA    aaa                   = Decoder Address
-            
-                if (ReceivedAddr == 0x01FF) 
-                  {
-                    ReceivedCommand &= 0x0007;
-                    return(2);  // basic paket - broadcast
-                  } 
-
-                if (ReceivedAddr == MyAddr) return(2);
-
-                #if (DEBUG_FEEDBACK == TRUE)
-
-                    if (ReceivedAddr == (MyAddr+1) )
-                      {
-                        ReceivedCommand &= 0x0007;
-                        ReceivedActivate = 0;   // remap this to the off command! (dirty!)
-                        return(2);
-                      }
-                #endif
-
-                if (ReceivedAddr > MyAddr) return(3);
-                return(1);  
-              }
-            else if (new_dcc->size == 6) // cv-access on the main
-              {
-                // Format:
-                // {preamble} 10AAAAAA 0 1AAACDDD 0 (1110CCAA 0 AAAAAAAA 0 DDDDDDDD) 0 EEEEEEEE 1
-
-                ReceivedCommand = new_dcc->dcc[1] & 0b00000111;   // CDDD: 1000-1111 individual output
-                                                             // 0000: all outputs
-                                                             // we ignore it.
-
-                ReceivedOperation = (new_dcc->dcc[2] & 0b00001100);// CC bits
-                ReceivedOperation = ReceivedOperation >> 2;   // CC bits
-                
-                ReceivedCV = ((new_dcc->dcc[2] & 0b00000011) << 8)
-                           | new_dcc->dcc[3];
+        received.type = 0;
+        received.addr = (new_dcc->dcc[0] & 0b01111111);
 
-                ReceivedData = new_dcc->dcc[4];
-
-                if (ReceivedAddr == MyAddr) 
-                  {
-                    cv_operation();             // note: this is not fully correct,
-                                                // we react on the first PoM-command, not on the second
-                  }
-              }
-          }
-        else if ((new_dcc->dcc[1] < 0b10000000) && (MyConfig != 0))
-          {                                         //// Extended Acc. (11 bit addr)
-
-            ReceivedAddr = (( new_dcc->dcc[1] & 0b00000110) >> 1)  // >>1
-                        | (( new_dcc->dcc[0] & 0b00111111) << 2) 
-                        | ((~new_dcc->dcc[1] & 0b01110000) >> 4);
-
-            MyAddr = (((my_eeprom_read_byte(&CV.myAddrH) & 0x7F) << 8) |
-                     (my_eeprom_read_byte(&CV.myAddrL))) - 1;
-
-            if (new_dcc->size == 4) // it's a command
-              { // Format:
-                // {preamble} 0 10AAAAAA 0 0AAA0AA1 0 000XXXXX 0 EEEEEEEE 1
-                // {preamble} 0 10111111 0 00000111 0 000XXXXX 0 EEEEEEEE 1
-                // output mode
-
-                ReceivedCommand = new_dcc->dcc[2] & 0b00011111;  // aspect
-
-                // take bits 2 1 from new_dcc->dcc[1]
-                // take bits 5 4 3 2 1 0 from new_dcc->dcc[0]
-                // take Bits 6 5 4 from new_dcc->dcc[1] and invert
-
-                if (ReceivedAddr == 0x07FF)
-                  {
-                    // broadcast
-                    return(2);
-                  }
-                if (ReceivedAddr == MyAddr) return(2);
-                else return(1);
-              }
-            else if (new_dcc->size == 6) // cv-access (on the main)
+        #if (FUNCTION_ENABLED == TRUE)
+            if ((my_decoder.fn_addr == received.addr) && !my_decoder.fn_long)
               {
-                // Format:
-                // {preamble} 0 10AAAAAA 0 0AAA0AA1 0 (1110CCAA 0 AAAAAAAA 0 DDDDDDDD) 0 EEEEEEEE 1
-
-                ReceivedOperation = (new_dcc->dcc[2] & 0b00001100);// CC bits
-                ReceivedOperation = ReceivedOperation >> 2; // CC bits
-                
-                ReceivedCV = ((new_dcc->dcc[2] & 0b00000011) << 8)
-                           | new_dcc->dcc[3];
-
-                ReceivedData = new_dcc->dcc[4];
-
-                if (ReceivedAddr == MyAddr) 
-                  {
-                    cv_operation();             // note: this is not fully correct,
-                                                // we react on the first PoM-command, not on the second
-                  }
+                return(analyze_loco(&new_dcc->dcc[1], new_dcc->size - 2));
               }
-          }
+        #endif
+      }
+    else if (new_dcc->dcc[0] <= 191)
+      {                                                 //// Accessory
+        return(analyze_accessory(new_dcc));
       }
     else if (new_dcc->dcc[0] <= 231)
       {
                                                         //// loco decoders (14 bit addr)
-        ReceivedAddr = ((new_dcc->dcc[0] & 0b00111111) << 8)
+        received.type = 0;
+        received.addr = ((new_dcc->dcc[0] & 0b00111111) << 8)
                     |  (new_dcc->dcc[1]);
+
+        #if (FUNCTION_ENABLED == TRUE)
+            if ((my_decoder.fn_addr == received.addr) && my_decoder.fn_long)
+              {
+                return(analyze_loco(&new_dcc->dcc[2], new_dcc->size - 3));
+              }
+        #endif
       }
     else if (new_dcc->dcc[0] <= 254)
       {                                                 //// Reserved in DCC for Future Use
@@ -605,6 +1041,13 @@ void init_dcc_decode(void)
     #if (DEBUG_PORTB7_IS_SM == TRUE)
       PORTB &= ~(1<<7);
     #endif
+    #if (DCC_PREFILTER == TRUE)
+      dcc_filter.open = 0;
+    #endif
+    load_decoder_context();
+    #if (DCC_DEDUP == TRUE)
+        init_dedup();
+    #endif
   }
 
 
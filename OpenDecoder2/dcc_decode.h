@@ -16,6 +16,10 @@
 // webpage:   http://www.opendcc.de
 // history:   2006-02-14 V0.1 kw start
 //            2007-04-27 V0.4 kw changed return codes
+//            2026-10-17          decoded packet in struct received,
+//                                address window (CV10)
+//            2026-10-17          dedup of repeated commands (dedup_stat)
+//            2026-10-17          loco state for the function decoder
 //
 //------------------------------------------------------------------------
 //
@@ -30,10 +34,11 @@
 //
 //            Step 3: init_dcc_receiver();
 //
-//            Step 4: check for semaphor C_Received; if so call analyze_message().
+//            Step 4: check for a message with get_dcc_message(); if so call analyze_message()
+//                    and free the message with release_dcc_message().
 //                    This checks the received DCC message
 //                    and returns a code
-//                    All relevant Data are stored to globals (Received...)
+//                    All relevant Data are stored to the global 'received'
 //
 
 /*
@@ -45,18 +50,57 @@ struct message
   };
 */
 
-extern unsigned int  ReceivedAddr;          // last received address - gets filled by dcc_decode
-extern unsigned int  ReceivedCommand;       // subaddress (starting from the first address)
-                                            // or aspect
-extern unsigned char  ReceivedActivate;      // coil
+#define RX_ACC          0x01                // accessory packet
+#define RX_EXT          0x02                // extended accessory (11 bit addr, aspect)
+#define RX_POM          0x04                // cv access on the main
+#define RX_BROADCAST    0x08
+#define RX_LOCO         0x10                // multifunction packet to our function address
+
+typedef struct
+  {
+    unsigned char type;                     // RX_x, bit field
+    unsigned int  addr;                     // received address (basic: 9 bit, extended: 11 bit)
+    unsigned char index;                    // position in our address window: addr - myAddr
+    unsigned int  command;                  // basic: index * 8 + coil (CDDD & 7)
+                                            // extended: index * 32 + aspect
+    unsigned char activate;                 // coil on (extended: always on)
+  } t_received;
+
+extern t_received received;                 // last decoded packet - gets filled by dcc_decode
+
+typedef struct
+  {
+    unsigned int hits;                      // repeated commands, dropped
+    unsigned int misses;                    // new commands, passed on
+  } t_dedup_stat;
+
+extern t_dedup_stat dedup_stat;             // only DCC_DEDUP
+
+#define FN_BIT_FORWARD  29                  // pseudo functions in loco.functions
+#define FN_BIT_MOVING   30
+
+typedef struct
+  {
+    unsigned long functions;                // bit n: Fn (F0..F28); bit 29: forward, bit 30: speed > 0
+    unsigned char speed;                    // 0: stop, 1: emergency stop, 2..127
+  } t_loco;
+
+extern t_loco loco;                         // state of the function address (FUNCTION_ENABLED)
 
 unsigned char analyze_message(t_message *new);        // this returns a code on the result:
-                                            // 0: if void,
+                                            // 0: if void (or a repeat),
                                             // 1: if accessory and command type equal our mode
                                             // 2: if accessory and address equal myAddr (or broadcast)
-                                            // 3: if accessory and address > myAddr (Received Command is extended)
+                                            // 3: if accessory and address in our window, but > myAddr
+                                            //    (command is extended)
+                                            // 4: if loco packet to our function address changed 'loco'
 
 void init_dcc_decode(void);
+
+void load_decoder_context(void);                     // reload address and config from CV
+                                                     // (and the prefilter of the receiver)
+
+void dedup_age(void);                                // DCC_DEDUP: call from the main loop
              
 
 
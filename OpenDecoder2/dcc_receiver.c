@@ -26,6 +26,28 @@
 //            2007-05-21 V0.5 kw added some comments
 //            2007-02-07 V0.6 kw changed preamble detection limit 
 //                               from 11 to 10 'one' bits
+//            2026-10-17          received messages are queued in a
+//                               ring buffer (dcc_queue) instead of
+//                               the single buffer incoming
+//            2026-10-17          added ALTERNATE_RECEIVE 2: half bit
+//                               timestamps with timer1, dcc_bitstat
+//            2026-10-17          ACK without busy waiting, ended by
+//                               the receiver ISR (ack_tick)
+//            2026-10-17          ALTERNATE_RECEIVE 2 starts the RailCom
+//                               cutout (railcom.c)
+//            2026-10-17          error counters in dcc_health (DCC_HEALTH)
+//            2026-10-17          ALTERNATE_RECEIVE 0: majority vote over
+//                               DCC_SAMPLES samples of DCCIN
+//            2026-10-17          ack_tick sums up the time since the last
+//                               call (timer1 period may be 5ms, SERVO_FRAME)
+//            2026-10-17          XOR while receiving, address prefilter
+//                               before the queue (DCC_PREFILTER)
+//            2026-10-17          ALTERNATE_RECEIVE 2: INT0 takes the
+//                               timestamp, then allows timer0 interrupts
+//            2026-10-17          DCC_SAMPLES 1 is the default again, 3 and
+//                               5 are build options
+//            2026-10-17          the ACK timeout without dcc ends the ACK
+//                               after its duration (dcc_ack.timeout)
 //
 //------------------------------------------------------------------------
 //
@@ -63,6 +85,7 @@
 #include "config.h"
 #include "hardware.h"            // Port and CPU definitions
 #include "dcc_receiver.h"
+#include "railcom.h"             // cutout after the packet end
 
 
 
@@ -70,22 +93,126 @@
                                  // 1: test receive routine
 
                                  
+#ifndef ALTERNATE_RECEIVE        // may be preset by the makefile
 #define ALTERNATE_RECEIVE  0     // 0: standard receiver
                                  // 1: add code for sampling receiver 
+                                 // 2: edge timestamp receiver (INT0 + timer1)
+#endif
+
+#ifndef DCC_SAMPLES              // may be preset by the makefile
+#define DCC_SAMPLES        1     // ALTERNATE_RECEIVE 0: samples of DCCIN per bit,
+#endif                           //   majority vote (1, 3 or 5)
+#define DCC_SAMPLE_GAP     4     // us between two samples
+
+#if ((DCC_SAMPLES != 1) && (DCC_SAMPLES != 3) && (DCC_SAMPLES != 5))
+  #error DCC_SAMPLES must be 1, 3 or 5
+#endif
+
+#if ((RAILCOM_ENABLED == TRUE) && (ALTERNATE_RECEIVE != 2))
+  #error RailCom needs the packet end of ALTERNATE_RECEIVE 2
+#endif
+
+#if ((DIMMER_ENABLED == TRUE) && (ALTERNATE_RECEIVE != 2))
+  #error the dimmer needs timer0, which is used by ALTERNATE_RECEIVE 0 and 1
+#endif
+
+#if ((SERVO_MUX == TRUE) && (ALTERNATE_RECEIVE != 2))
+  #error the multiplexed servos need timer0, which is used by ALTERNATE_RECEIVE 0 and 1
+#endif
                                  
 
 
 //---------------------------------------------------------------------------
 
-// Note: ACK is done with busy waiting - will be stretched when interrupts occur.
+// ACK generator
+//
+// activate_ACK() does not wait: it queues the request; if no ACK is running,
+// DCC_ACK is set at once. The end of an ACK is found by ack_tick(), which
+// is called by the receiver ISR at every dcc bit and adds the TCNT1 ticks
+// since its last call - so the pulse is not stretched by other interrupts
+// and main runs on. The sum works across several timer1 periods (an ACK of
+// 6ms is longer than a SERVO_FRAME of 5ms), as long as two calls are less
+// than one period apart. Between two queued ACKs there is a gap of ACK_GAP ms.
+// Without dcc there is no tick; then TIMER1_OVF (port_engine.c) ends the
+// ACK and drops the queue: dcc_ack.timeout is the end of the state plus
+// 1ms, in timer1 ticks after the last overflow; TIMER1_OVF subtracts a
+// period (ICR1 + 1) at each overflow and ends the state in the period in
+// which the timeout falls. So the ACK lasts its duration plus 1ms up to
+// one timer1 period more. The 1ms lets the receiver end the state first
+// as long as there is dcc.
+
+#define ACK_GAP         2                           // ms between queued ACKs
+#define ACK_T1_TICKS(ms)  ((ms) * (F_CPU / 8 / 1000L)) // timer1 runs with prescaler 8
+
+volatile t_dcc_ack dcc_ack;
+
+static inline void ack_start(unsigned int now, unsigned char state, unsigned char time) 
+       __attribute__((always_inline));
+void ack_start(unsigned int now, unsigned char state, unsigned char time)
+  {
+    dcc_ack.state = state;
+    dcc_ack.last = now;
+    dcc_ack.elapsed = 0;
+    dcc_ack.duration = ACK_T1_TICKS(time);
+    dcc_ack.timeout = now + ACK_T1_TICKS(time + 1);
+    if (TIFR & (1<<TOV1))                           // now is after an overflow
+        dcc_ack.timeout += ICR1 + 1;                //   TIMER1_OVF has yet to count
+  }
+
+static inline void ack_tick(unsigned int now) __attribute__((always_inline));
+void ack_tick(unsigned int now)
+  {
+    unsigned int delta;
+
+    if (dcc_ack.state == ACK_IDLE) return;
+
+    delta = now - dcc_ack.last;
+    if (now < dcc_ack.last) delta += ICR1 + 1;      // timer1 wrapped at TOP
+    dcc_ack.last = now;
+    dcc_ack.elapsed += delta;
+    if (dcc_ack.elapsed < dcc_ack.duration) return;
+
+    if (dcc_ack.state == ACK_ON)
+      {
+        DCC_ACK_OFF;
+        ack_start(now, ACK_GAP_RUN, ACK_GAP);
+      }
+    else if (dcc_ack.read != dcc_ack.write)
+      {
+        DCC_ACK_ON;
+        ack_start(now, ACK_ON, dcc_ack.time[dcc_ack.read & (ACK_QUEUE_SIZE-1)]);
+        dcc_ack.read++;
+      }
+    else
+      {
+        dcc_ack.state = ACK_IDLE;
+      }
+  }
 
 void activate_ACK(unsigned char time)
   {
-    unsigned char i;
     // set ACK for  time [ms]
-    DCC_ACK_ON;
-    for (i=0; i<time; i++) _mydelay_us(1000);
-    DCC_ACK_OFF;    
+    if (time > ACK_MAX_TIME) time = ACK_MAX_TIME;
+    cli();
+    if (dcc_ack.state == ACK_IDLE)
+      {
+        DCC_ACK_ON;
+        ack_start(TCNT1, ACK_ON, time);
+      }
+    else if ((unsigned char)(dcc_ack.write - dcc_ack.read) < ACK_QUEUE_SIZE)
+      {
+        dcc_ack.time[dcc_ack.write & (ACK_QUEUE_SIZE-1)] = time;
+        dcc_ack.write++;
+      }
+    sei();
+  }
+
+void wait_ACK(void)
+  {
+    while (dcc_ack.state != ACK_IDLE)
+      {
+        HOST_WAIT();
+      }
   }
 
 
@@ -127,10 +254,14 @@ void activate_ACK(unsigned char time)
     unsigned char Recstate;         
 #endif
 
-t_message incoming;
+volatile t_dcc_queue dcc_queue;
+
+volatile t_dcc_health dcc_health;
 
 volatile t_message local;
 
+volatile t_dcc_filter dcc_filter;
+
 
 struct
     {
@@ -138,6 +269,7 @@ struct
         unsigned char bitcount;                 // current bit
         unsigned char bytecount;                // pointer to current byte
         unsigned char accubyte;                 // location for bit stuffing
+        unsigned char xor;                      // XOR of the received bytes
         signed char dcc_time;                   // integration time for dcc (only sampling code)
                                                 // we start with -7 -> all values >= indicate a zero
         unsigned char filter_data;              // bitfield for low pass data
@@ -154,6 +286,83 @@ struct
 #define RECSTAT_DCC          7   
 
 
+//------------------------------------------------------------------------------
+// Message queue: single producer (ISR) / single consumer (main)
+//
+// write is only changed by the ISR, read only by main; both are free running
+// and used modulo DCC_QUEUE_SIZE, so no locking is required. The ISR publishes
+// a message by incrementing write after the copy is complete.
+
+static inline void put_dcc_message(void) __attribute__((always_inline));
+void put_dcc_message(void)
+  {
+    unsigned char level;
+    unsigned char i;
+    t_message *dest;
+
+    level = dcc_queue.write - dcc_queue.read;
+    if (level >= DCC_QUEUE_SIZE)
+      {
+        // panic - nobody is reading the messages :-((
+        if (dcc_queue.overflow != 255) dcc_queue.overflow++;
+        DCC_HEALTH_INC(overrun);
+        return;
+      }
+
+    dest = (t_message *)&dcc_queue.msg[dcc_queue.write & (DCC_QUEUE_SIZE-1)];
+    for (i=0; i<MAX_DCC_SIZE; i++)
+      {
+         dest->dcc[i] = local.dcc[i];
+      }
+    dest->size = dccrec.bytecount;
+
+    level++;
+    if (level > dcc_queue.max_level) dcc_queue.max_level = level;
+
+    dcc_queue.write++;                                  // ---> tell the main prog!
+  }
+
+t_message *get_dcc_message(void)
+  {
+    if (dcc_queue.read == dcc_queue.write) return(0);   // empty
+    return((t_message *)&dcc_queue.msg[dcc_queue.read & (DCC_QUEUE_SIZE-1)]);
+  }
+
+void release_dcc_message(void)
+  {
+    dcc_queue.read++;
+  }
+
+//------------------------------------------------------------------------------
+// End bit of a packet received
+//
+// With DCC_PREFILTER the XOR (built byte by byte in dccrec.xor) is checked
+// here, and packets which cannot be for us (idle, other addresses, see
+// dcc_prefilter) are dropped - main is only woken for packets it may use.
+
+static inline void packet_end(void) __attribute__((always_inline));
+void packet_end(void)
+  {
+    #if (HOST_BUILD == TRUE)
+        host_trace_message(local.dcc, dccrec.bytecount);    // host: -w tracefile
+    #endif
+    #if (DCC_PREFILTER == TRUE)
+        if (dccrec.xor)
+          {
+            DCC_HEALTH_INC(xor_error);
+            return;
+          }
+        DCC_HEALTH_INC(accepted);
+        if (!dcc_prefilter(local.dcc))
+          {
+            if (dcc_filter.dropped != 0xFFFF) dcc_filter.dropped++;
+            return;
+          }
+    #endif
+    put_dcc_message();
+  }
+
+
 
 #if (ALTERNATE_RECEIVE == 0)
 
@@ -177,7 +386,11 @@ void init_dcc_receiver(void)
 
 //    #define T87US (F_CPU * PERIOD_1 * 3 / 4 / T0_PRESCALER / 1000000L)
 
-    #define T87US (F_CPU * 77L / T0_PRESCALER / 1000000L)
+    // with DCC_SAMPLES > 1 the samples are centered at 77us
+    #define T_FIRST_SAMPLE  (77L - (DCC_SAMPLES - 1) * DCC_SAMPLE_GAP / 2)
+    #define T87US (F_CPU * T_FIRST_SAMPLE / T0_PRESCALER / 1000000L)
+
+    #define T_SPIKE (F_CPU * 10L / T0_PRESCALER / 1000000L)   // 10us after the edge
 
 
     #if (T87US > 254)
@@ -201,9 +414,14 @@ void init_dcc_receiver(void)
 
     TCNT0 = 256L - T87US;  
 
-    // OCR0 is unused -> Flags!
+    dcc_queue.read = dcc_queue.write;           // empty
 
-    semaphor_get(C_Received);
+    #if (DCC_SAMPLES > 1)
+        OCR0 = 256L - T87US + T_SPIKE;
+        TIMSK |= (1<<OCIE0);   // Timer0 Compare: spike check
+    #else
+        // OCR0 is unused -> Flags!
+    #endif
 
     TIMSK |= (1<<TOIE0);       // Timer0 Overflow
 
@@ -240,11 +458,32 @@ void init_dcc_receiver(void)
 //                           ^-INT0
 //                           |----------->|
 //                                        ^Timer-INT: reads one
+//
+//           Spikes (coil drives, servo motors on the same supply) hurt
+//           in two ways, both are filtered with DCC_SAMPLES 3 or 5 (build
+//           option, make DCC_SAMPLES=3; the default 1 is the receiver
+//           without these filters):
+//           a) a spike in the low phase starts timer0 too early.
+//              TIMER0_COMP checks DCCIN T_SPIKE us after the edge; if it
+//              is low again, timer0 is stopped and waits for the next
+//              rising edge.
+//           b) a spike hits the sample point. DCCIN is read every
+//              DCC_SAMPLE_GAP us around 77us and the majority wins; a
+//              spike shorter than DCC_SAMPLE_GAP changes only one sample.
+//              The samples are read at 73/77/81us (3) or 69..85us (5),
+//              inside the NMRA limits (52us for a '1', 90us for a '0').
+//           Cost: TIMER0_OVF is longer by (DCC_SAMPLES-1) * 4us, this is
+//           8us / 64 cycles (3) or 16us / 128 cycles (5) per bit, about
+//           7% / 14% of the cpu with '1' bits (host: OpenDecoder2_host,
+//           line 'isr time', counts the delay loops); plus one short
+//           TIMER0_COMP per bit. Check the cycles of such a build with
+//           make DCC_SAMPLES=3 isrbench (tools/isr_budget.txt).
 //           
 // Result:   1. The received message is collected in the struct "local"
 //           2. After receiving a complete message, data is copied to
-//              "incoming".
-//           3. The flag C_Received is set.
+//              the next free entry of "dcc_queue".
+//           3. main gets it with get_dcc_message() and frees it with
+//              release_dcc_message().
 //
 
 // here just a repetition of the defines in dcc_receiver.h
@@ -263,7 +502,9 @@ void init_dcc_receiver(void)
 // therefore we define a naked version of the ISR with
 // no compiler overhead.
 
-#define ISR_INT0_OPTIMIZED
+#if (HOST_BUILD == FALSE)                       // host: no inline assembler
+  #define ISR_INT0_OPTIMIZED
+#endif
 
 #ifdef ISR_INT0_OPTIMIZED
     #ifdef ISR_NAKED
@@ -307,6 +548,18 @@ void init_dcc_receiver(void)
 
 #endif
 
+#if (DCC_SAMPLES > 1)
+ISR(TIMER0_COMP_vect)
+  {
+    if (!DCCIN_STATE)                           // short after the edge low again:
+      {                                         // spike -> wait for the next edge
+        TCCR0 = 0;                              // stop
+        TCNT0 = 256L - T87US;
+        DCC_HEALTH_INC(spike);
+      }
+  }
+#endif
+
 const unsigned char copy[] PROGMEM = {"OpenDecoder2 v0.12 (c) Kufer 2010"};
 
 
@@ -315,8 +568,23 @@ ISR(TIMER0_OVF_vect)
     #define mydcc (Recstate & (1<<RECSTAT_DCC))
 
     // read asap to keep timing!
+    #if (DCC_SAMPLES == 1)
     if (DCCIN_STATE) Recstate &= ~(1<<RECSTAT_DCC);  // if high -> mydcc=0
     else             Recstate |= 1<<RECSTAT_DCC;    
+    #else
+      {
+        unsigned char i, high = 0;
+
+        for (i=0; i<DCC_SAMPLES; i++)
+          {
+            if (DCCIN_STATE) high++;
+            if (i < DCC_SAMPLES - 1)                     // loop itself takes ~2 cycles
+                _delay_loop_1(F_CPU / 1000000L * DCC_SAMPLE_GAP / 3 - 1);
+          }
+        if (high > DCC_SAMPLES / 2) Recstate &= ~(1<<RECSTAT_DCC);  // majority high -> mydcc=0
+        else                        Recstate |= 1<<RECSTAT_DCC;    
+      }
+    #endif
 
     TCCR0 = (0 << FOC0)        // force output: 0=not
            | (0 << WGM00)       // wgm = 00: normal mode, top=0xff
@@ -332,6 +600,8 @@ ISR(TIMER0_OVF_vect)
     
     TCNT0 = 256L - T87US;  
 
+    ack_tick(TCNT1);                                    // end of ACK?
+
     dccrec.bitcount++;
 
     if (Recstate & (1<<RECSTAT_WF_PREAMBLE))            // wait for preamble
@@ -345,6 +615,7 @@ ISR(TIMER0_OVF_vect)
           }
         else
           {
+            if (dccrec.bitcount > 1) DCC_HEALTH_INC(preamble_abort);
             dccrec.bitcount=0;
           }
       }
@@ -356,6 +627,7 @@ ISR(TIMER0_OVF_vect)
         else
           {
             dccrec.bytecount=0;
+            dccrec.xor=0;
             Recstate = 1<<RECSTAT_WF_BYTE;
             dccrec.bitcount=0;
             dccrec.accubyte=0;
@@ -381,11 +653,13 @@ ISR(TIMER0_OVF_vect)
           {
             if (dccrec.bytecount == MAX_DCC_SIZE)       // too many bytes
               {                                         // ignore message
+                DCC_HEALTH_INC(oversize);
                 Recstate = 1<<RECSTAT_WF_PREAMBLE;   
               }
             else
               {
                 local.dcc[dccrec.bytecount++] = dccrec.accubyte;
+                dccrec.xor ^= dccrec.accubyte;
                 Recstate = 1<<RECSTAT_WF_TRAILER; 
               }
           }
@@ -397,21 +671,7 @@ ISR(TIMER0_OVF_vect)
             Recstate = 1<<RECSTAT_WF_PREAMBLE;
             dccrec.bitcount=1;
 
-            if (semaphor_query(C_Received))
-              {
-                // panic - nobody is reading the messages :-((
-              }
-            else
-              {                                         // copy from local to global
-                unsigned char i;
-                for (i=0; i<MAX_DCC_SIZE; i++)
-                  {
-                     incoming.dcc[i] = local.dcc[i];
-                  }
-                incoming.size = dccrec.bytecount;
-                semaphor_set(C_Received);                   // ---> tell the main prog!
-              }
-            
+            packet_end();                               // check, copy from local to queue
           }
         else
           {
@@ -451,6 +711,7 @@ void dcc_receive(void)
           }
         else
           {
+            if (dccrec.bitcount > 1) DCC_HEALTH_INC(preamble_abort);
             dccrec.bitcount=0;
           }
       }
@@ -462,6 +723,7 @@ void dcc_receive(void)
         else
           {
             dccrec.bytecount=0;
+            dccrec.xor=0;
             Recstate = 1<<RECSTAT_WF_BYTE;
             dccrec.bitcount=0;
             dccrec.accubyte=0;
@@ -478,11 +740,13 @@ void dcc_receive(void)
           {
             if (dccrec.bytecount == MAX_DCC_SIZE)        // too many bytes
               {                                         // ignore message
+                DCC_HEALTH_INC(oversize);
                 Recstate = 1<<RECSTAT_WF_PREAMBLE;   
               }
             else
               {
                 local.dcc[dccrec.bytecount++] = dccrec.accubyte;
+                dccrec.xor ^= dccrec.accubyte;
                 Recstate = 1<<RECSTAT_WF_TRAILER; 
               }
           }
@@ -494,20 +758,7 @@ void dcc_receive(void)
             Recstate = 1<<RECSTAT_WF_PREAMBLE;
             dccrec.bitcount=1;
             
-            if (semaphor_query(C_Received))
-              {
-                // panic - nobody is reading the messages :-((
-              }
-            else
-              {                                         // copy from local to global
-                unsigned char i;
-                for (i=0; i<MAX_DCC_SIZE; i++)
-                  {
-                     incoming.dcc[i] = local.dcc[i];
-                  }
-                incoming.size = dccrec.bytecount;
-                semaphor_set(C_Received);                   // ---> tell the main prog!
-              }
+            packet_end();                               // check, copy from local to queue
           }
         else
           {
@@ -576,7 +827,7 @@ void init_dcc_receiver(void)
 
     OCR0 = (F_CPU * 10L / T0_PRESCALER / 1000000L);
 
-    semaphor_get(C_Received);
+    dcc_queue.read = dcc_queue.write;           // empty
 
     TIMSK |= (1<<OCIE0);       // Timer0 compare
   }
@@ -658,6 +909,8 @@ ISR(TIMER0_COMP_vect)
           }
         else
           {
+            ack_tick(TCNT1);                                    // once per bit
+
             dccrec.bitcount++;
 
             if (Recstate & (1<<RECSTAT_WF_PREAMBLE))            // wait for preamble
@@ -671,6 +924,7 @@ ISR(TIMER0_COMP_vect)
                   }
                 else
                   {
+                    if (dccrec.bitcount > 1) DCC_HEALTH_INC(preamble_abort);
                     dccrec.bitcount=0;
                   }
               }
@@ -682,6 +936,7 @@ ISR(TIMER0_COMP_vect)
                 else
                   {
                     dccrec.bytecount=0;
+                    dccrec.xor=0;
                     Recstate = (1<<RECSTAT_WF_BYTE)
                              | (1<<RECSTAT_WF_SECOND_H);
                              
@@ -706,11 +961,13 @@ ISR(TIMER0_COMP_vect)
                   {
                     if (dccrec.bytecount == MAX_DCC_SIZE)        // too many bytes
                       {                                         // ignore message
+                        DCC_HEALTH_INC(oversize);
                         Recstate = 1<<RECSTAT_WF_PREAMBLE;   
                       }
                     else
                       {
                         local.dcc[dccrec.bytecount++] = dccrec.accubyte;
+                        dccrec.xor ^= dccrec.accubyte;
                         dccrec.accubyte = 0;
                         Recstate = (1<<RECSTAT_WF_TRAILER)
                                  | (1<<RECSTAT_WF_SECOND_H);
@@ -723,20 +980,7 @@ ISR(TIMER0_COMP_vect)
                   {  // trailing "1" received
                     Recstate = 1<<RECSTAT_WF_PREAMBLE;
                     dccrec.bitcount=1;
-                    if (semaphor_query(C_Received))
-                      {
-                        // panic - nobody is reading the messages :-((
-                      }
-                    else
-                      {                                         // copy from local to global
-                        unsigned char i;
-                        for (i=0; i<MAX_DCC_SIZE; i++)
-                          {
-                             incoming.dcc[i] = local.dcc[i];
-                          }
-                        incoming.size = dccrec.bytecount;
-                        semaphor_set(C_Received);                   // ---> tell the main prog!
-                      }
+                    packet_end();                               // check, copy from local to queue
                   }
                 else
                   {
@@ -763,3 +1007,254 @@ ISR(TIMER0_COMP_vect)
 
 #endif   // ALTERNATE_RECEIVE == 1
 
+
+#if (ALTERNATE_RECEIVE == 2)
+//==============================================================================
+//
+// Section 2b
+//
+// DCC Receive Routine - edge timestamps
+//
+// Howto:    INT0 triggers on both edges of DCC. Timer1 runs free with 1us
+//           (port engine, TOP=ICR1, SERVO_FRAME); at every edge TCNT1 is taken as
+//           timestamp, the difference to the last edge is the duration of
+//           a half bit. This works like input capture, but on the INT0 pin.
+//
+//           Each half bit is checked against the NMRA windows:
+//               '1':  52us ...    64us
+//               '0':  90us ... 10000us
+//           Two equal halves make a bit. If the halves differ, the first
+//           one is dropped (we were out of phase by one half bit).
+//           A half outside both windows restarts the receiver.
+//
+//           Timer0 is not used. DCC polarity does not matter.
+//           With a SERVO_FRAME of 5ms, a stretched '0' longer than the
+//           frame is not measured correctly (restarts the receiver).
+//
+// Limit:    TCNT1 is read in software, not captured by hardware. An edge
+//           which comes while an other ISR blocks the interrupts gets a
+//           late timestamp, both halves around it are measured wrong by
+//           this delay. Against the window of 52..64us a '1' half bit
+//           of the nominal 58us has 6us (48 cycles) margin, one at the
+//           limit of a command station (55..61us) only 3us (24 cycles).
+//           No ISR may block INT0 for more than 40 cycles (5us, see
+//           tools/isr_budget.txt); with a station at the limit of its
+//           range a half bit which meets such a block can still be lost.
+//           Therefore:
+//           - INT0 takes the timestamp, masks itself and the timetick
+//             (TOIE1) and enables the interrupts; the half bit is
+//             evaluated in dcc_edge(), interruptible by timer0
+//           - TIMER1_OVF enables the interrupts at once (ISR_NOBLOCK)
+//           - RailCom (TIMER0_COMP) blocks longer, but edges come only
+//             without a cutout, in the first bit of the next preamble
+//           - the dimmer ISRs mask timer0 and TOIE1 and enable the
+//             interrupts at once (dimmer.c)
+//           - the servo mux writes its edge and OCR0 first, then masks
+//             TOIE1 and enables the interrupts (servo.c)
+//           Everything in dcc_edge() plus a nested timer0 ISR must end
+//           before the next edge (52us), otherwise INT0 comes late.
+//
+// Result:   same as standard receiver (dcc_queue), additional timing
+//           statistics in dcc_bitstat.
+//
+
+#define DCC_T1_PRESCALER   8            // must be the same as T1_PRESCALER in port_engine.c
+
+#define T1_TICKS(us)       (F_CPU / 1000000L * (us) / DCC_T1_PRESCALER)
+
+#define HALF_ONE_MIN       T1_TICKS(52)
+#define HALF_ONE_MAX       T1_TICKS(64)
+#define HALF_ZERO_MIN      T1_TICKS(90)
+#define HALF_ZERO_MAX      T1_TICKS(10000)
+
+#define HALF_NONE          0
+#define HALF_ONE           1
+#define HALF_ZERO          2
+
+t_dcc_bitstat dcc_bitstat;
+
+volatile unsigned int dcc_last_edge;    // TCNT1 at last edge (also used by railcom)
+static unsigned int prev_edge;          // dcc_edge: TCNT1 of the edge before
+static unsigned char first_half;        // HALF_x of the first half of current bit
+static unsigned char int0_tick;         // INT0: TOIE1 before it was masked
+
+
+void init_dcc_receiver(void)
+  {
+    dcc_bitstat.one_min = 0xFFFF;
+    dcc_bitstat.zero_min = 0xFFFF;
+
+    first_half = HALF_NONE;
+    Recstate = 1<<RECSTAT_WF_PREAMBLE;
+
+    dcc_queue.read = dcc_queue.write;           // empty
+
+    // Timer1 is set up by init_port_engine()
+
+    // Init Interrupt 0
+
+    MCUCR = (MCUCR & ~((1<<ISC01) | (1<<ISC00)))
+          | (0<<ISC01)
+          | (1<<ISC00);     //  Any logical change on INT0 generates an interrupt request.
+
+    GICR |= (1<<INT0);       // Enable INT0
+  }
+
+
+static inline void receive_bit(unsigned char mydcc) __attribute__((always_inline));
+void receive_bit(unsigned char mydcc)
+  {
+    dccrec.bitcount++;
+
+    if (Recstate & (1<<RECSTAT_WF_PREAMBLE))            // wait for preamble
+      {                                       
+        if (mydcc)
+          {
+            if (dccrec.bitcount >= 10) 
+              {
+                Recstate = 1<<RECSTAT_WF_LEAD0;            
+              }
+          }
+        else
+          {
+            if (dccrec.bitcount > 1) DCC_HEALTH_INC(preamble_abort);
+            dccrec.bitcount=0;
+          }
+      }
+    else if (Recstate & (1<<RECSTAT_WF_LEAD0))          // wait for leading 0
+      {
+        if (mydcc)
+          {                                             // still 1, wait again
+          }
+        else
+          {
+            dccrec.bytecount=0;
+            dccrec.xor=0;
+            Recstate = 1<<RECSTAT_WF_BYTE;
+            dccrec.bitcount=0;
+            dccrec.accubyte=0;
+          }
+      }
+    else if (Recstate & (1<<RECSTAT_WF_BYTE))           // wait for byte
+      {
+        unsigned char my_accubyte;
+        my_accubyte = dccrec.accubyte << 1;
+        if (mydcc)
+          {
+            my_accubyte |= 1;
+          }
+        dccrec.accubyte = my_accubyte;
+        
+        if (dccrec.bitcount==8)
+          {
+            if (dccrec.bytecount == MAX_DCC_SIZE)       // too many bytes
+              {                                         // ignore message
+                DCC_HEALTH_INC(oversize);
+                Recstate = 1<<RECSTAT_WF_PREAMBLE;   
+              }
+            else
+              {
+                local.dcc[dccrec.bytecount++] = dccrec.accubyte;
+                dccrec.xor ^= dccrec.accubyte;
+                Recstate = 1<<RECSTAT_WF_TRAILER; 
+              }
+          }
+      }
+    else if (Recstate & (1<<RECSTAT_WF_TRAILER))        // wait for 0 (next byte) 
+      {                                                 // or 1 (eof message)
+        if (mydcc)
+          {  // trailing "1" received
+            Recstate = 1<<RECSTAT_WF_PREAMBLE;
+            dccrec.bitcount=1;
+            packet_end();                               // check, copy from local to queue
+
+            #if (RAILCOM_ENABLED == TRUE)
+                if (dccrec.xor == 0)                    // only after valid packets
+                  {
+                    railcom_packet_end(local.dcc, dcc_last_edge);
+                  }
+            #endif
+          }
+        else
+          {
+            Recstate = 1<<RECSTAT_WF_BYTE;
+            dccrec.bitcount=0;
+            dccrec.accubyte=0;
+          }
+      }
+    else
+      {
+        Recstate = 1<<RECSTAT_WF_PREAMBLE;
+      }
+  }
+
+
+// evaluate the half bit which ended at 'now' (interrupts enabled)
+static void dcc_edge(unsigned int now) __attribute__((noinline));
+void dcc_edge(unsigned int now)
+  {
+    unsigned int half;
+    unsigned char kind;
+
+    half = now - prev_edge;
+    if (now < prev_edge) half += ICR1 + 1;      // timer1 wrapped at TOP
+    prev_edge = now;
+
+    ack_tick(now);                              // end of ACK?
+
+    if ((half >= HALF_ONE_MIN) && (half <= HALF_ONE_MAX))
+      {
+        kind = HALF_ONE;
+        if (half < dcc_bitstat.one_min) dcc_bitstat.one_min = half;
+        if (half > dcc_bitstat.one_max) dcc_bitstat.one_max = half;
+      }
+    else if ((half >= HALF_ZERO_MIN) && (half <= HALF_ZERO_MAX))
+      {
+        kind = HALF_ZERO;
+        if (half < dcc_bitstat.zero_min) dcc_bitstat.zero_min = half;
+        if (half > dcc_bitstat.zero_max) dcc_bitstat.zero_max = half;
+      }
+    else
+      {                                         // glitch or gap -> restart
+        if (dcc_bitstat.bad_half != 0xFFFF) dcc_bitstat.bad_half++;
+        first_half = HALF_NONE;
+        Recstate = 1<<RECSTAT_WF_PREAMBLE;
+        dccrec.bitcount = 0;
+        return;
+      }
+
+    if (first_half == HALF_NONE)
+      {
+        first_half = kind;
+        return;
+      }
+    if (first_half != kind)
+      {                                         // out of phase: drop first half
+        if (dcc_bitstat.asym != 0xFFFF) dcc_bitstat.asym++;
+        first_half = kind;
+        return;
+      }
+    first_half = HALF_NONE;
+
+    if (dcc_bitstat.bits != 0xFFFF) dcc_bitstat.bits++;
+    receive_bit(kind == HALF_ONE);
+  }
+
+ISR(INT0_vect)
+  {
+    unsigned int now;
+
+    now = TCNT1;                                // read asap to keep timing!
+    dcc_last_edge = now;                        // before sei: railcom reads it
+    GICR &= ~(1<<INT0);                         // no INT0 within dcc_edge
+    int0_tick = TIMSK & (1<<TOIE1);             // no timetick either: it runs
+    TIMSK &= ~(1<<TOIE1);                       //   up to 0.5ms with sei
+    sei();                                      // timer0 ISRs may come in
+    dcc_edge(now);
+    cli();
+    TIMSK |= int0_tick;
+    GICR |= (1<<INT0);
+  }
+
+#endif   // ALTERNATE_RECEIVE == 2
+
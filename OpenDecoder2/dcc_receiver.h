@@ -15,6 +15,13 @@
 // contact:   kufer@gmx.de
 // webpage:   http://www.opendcc.de
 // history:   2006-02-14 V0.1 kw start
+//            2026-10-17          dcc_queue replaces incoming
+//            2026-10-17          activate_ACK does not wait (dcc_ack)
+//            2026-10-17          address prefilter (dcc_filter)
+//            2026-10-17          dcc_ack: time of a state is summed up per
+//                               tick, may be longer than a timer1 period
+//            2026-10-17          dcc_ack.timeout: end of the state without
+//                               dcc, counted down by TIMER1_OVF
 //
 //------------------------------------------------------------------------
 //
@@ -23,12 +30,17 @@
 //------------------------------------------------------------------------
 //
 // howto:     Step 1: call init_dcc_receiver()
-//            Step 2: every time a new message is received, the
-//                    semaphor_set is called with C_Received = 1
-//            Step 3: The host program can now read the message incoming;
-//                    The message must be read within the next
-//                    2ms and must be checked by the host,
+//            Step 2: every time a new message is received, it is put
+//                    to dcc_queue (up to DCC_QUEUE_SIZE messages)
+//            Step 3: The host program gets the oldest message with
+//                    get_dcc_message() (0 if none), checks it and
+//                    frees the entry with release_dcc_message().
 //                    dcc_receiver makes only the physical layer.
+//                    If the queue is full, the message is lost and
+//                    dcc_queue.overflow is incremented.
+//            DCC_PREFILTER: the receiver checks the XOR and queues only
+//                    packets which may be for us (dcc_prefilter); the
+//                    decoder keeps dcc_filter up to date.
 //
 
 
@@ -40,11 +52,119 @@ typedef struct
   } t_message;
 
 
-extern t_message incoming;         // here we deliver the incoming message
+#define DCC_QUEUE_SIZE  4                 // must be a power of 2
+
+typedef struct
+  {
+    unsigned char write;              // next free entry - only changed by ISR
+    unsigned char read;               // oldest entry - only changed by main
+    unsigned char overflow;           // lost messages (queue full), stops at 255
+    unsigned char max_level;          // max. number of queued messages
+    t_message msg[DCC_QUEUE_SIZE];
+  } t_dcc_queue;
+
+extern volatile t_dcc_queue dcc_queue;  // here we deliver the incoming messages
+
+t_message *get_dcc_message(void);       // oldest message, 0 if empty
+void release_dcc_message(void);         // oldest message is done
+
+typedef struct                        // only ALTERNATE_RECEIVE 2
+  {                                   // times in timer1 ticks (1us at 8MHz)
+    unsigned int one_min;             // shortest / longest half bit '1'
+    unsigned int one_max;
+    unsigned int zero_min;            // shortest / longest half bit '0'
+    unsigned int zero_max;
+    unsigned int bits;                // received bits
+    unsigned int bad_half;            // half bit outside NMRA windows
+    unsigned int asym;                // halves of a bit not equal
+  } t_dcc_bitstat;                    // counters stop at 0xFFFF
+
+extern t_dcc_bitstat dcc_bitstat;
+
+typedef struct                        // receiver health (DCC_HEALTH)
+  {
+    unsigned int accepted;            // packets with correct XOR (receiver or analyze_message)
+    unsigned int xor_error;           // packets with wrong XOR (receiver or analyze_message)
+    unsigned int overrun;             // packet lost, dcc_queue full
+    unsigned int oversize;            // more than MAX_DCC_SIZE bytes
+    unsigned int preamble_abort;      // '0' after an incomplete preamble
+    unsigned int spike;               // rejected start edges (ALTERNATE_RECEIVE 0)
+  } t_dcc_health;                     // counters stop at 0xFFFF
+
+extern volatile t_dcc_health dcc_health;
+
+#if (DCC_HEALTH == TRUE)
+  #define DCC_HEALTH_INC(x)   if (dcc_health.x != 0xFFFF) dcc_health.x++
+#else
+  #define DCC_HEALTH_INC(x)
+#endif
+
+typedef struct                        // address prefilter (DCC_PREFILTER)
+  {                                   // written by main, read by the receiver ISR
+    unsigned char open;               // != 0: pass all packets (FILTER_x)
+    unsigned char acc[8];             // accessory: bit (dcc[0] & 0x3F) set -> pass
+    unsigned char loco0;              // function address: first byte, 0 = none
+    unsigned char loco1;              //   second byte, only if loco_long
+    unsigned char loco_long;
+    unsigned int dropped;             // packets not for us, stops at 0xFFFF
+  } t_dcc_filter;
+
+#define FILTER_SM       0             // service mode (112..127, idle for the timeout)
+#define FILTER_PROG     1             // DoProgramming learns from any accessory packet
+
+extern volatile t_dcc_filter dcc_filter;
+
+//------------------------------------------------------------------------
+// classify the first byte of a packet with correct XOR:
+// idle 0xFF: drop, broadcast 0x00: pass, accessory: pass if the low 6
+// address bits may be in our window, loco: pass only our function address
+
+static inline unsigned char dcc_prefilter(const volatile unsigned char *dcc)
+       __attribute__((always_inline));
+
+unsigned char dcc_prefilter(const volatile unsigned char *dcc)
+  {
+    unsigned char first = dcc[0];
+
+    if (dcc_filter.open) return(TRUE);
+    if (first == 0x00) return(TRUE);                        // broadcast
+    if ((first & 0xC0) == 0x80)                             // accessory
+      {
+        return(dcc_filter.acc[(first >> 3) & 0x07] & (1 << (first & 0x07)));
+      }
+    if (first != dcc_filter.loco0) return(FALSE);           // idle, other locos
+    return(!dcc_filter.loco_long || (dcc[1] == dcc_filter.loco1));
+  }
+
+extern volatile unsigned int dcc_last_edge;     // only ALTERNATE_RECEIVE 2: TCNT1 of last edge
 
 void init_dcc_receiver(void);
 
-void activate_ACK(unsigned char time);          // make prog or feedback ack
+#define ACK_QUEUE_SIZE  4                 // must be a power of 2
+#define ACK_MAX_TIME    15                // ms
+
+#define ACK_IDLE        0
+#define ACK_ON          1                 // DCC_ACK is set
+#define ACK_GAP_RUN     2                 // pause before the next queued ACK
+
+typedef struct
+  {
+    unsigned char state;              // ACK_IDLE, ACK_ON, ACK_GAP_RUN
+    unsigned int timeout;             // end without dcc, ticks after the last
+                                      //   timer1 overflow (TIMER1_OVF)
+    unsigned int last;                // TCNT1 at the last ack_tick
+    unsigned int elapsed;             // timer1 ticks in this state
+    unsigned int duration;            // length of state in timer1 ticks
+    unsigned char write;              // queued ACKs (time in ms),
+    unsigned char read;               //   same scheme as dcc_queue
+    unsigned char time[ACK_QUEUE_SIZE];
+  } t_dcc_ack;
+
+extern volatile t_dcc_ack dcc_ack;
+
+void activate_ACK(unsigned char time);          // make prog or feedback ack,
+                                                // returns at once (queued)
+void wait_ACK(void);                            // until all ACKs are done
 
 
              
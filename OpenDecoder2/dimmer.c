@@ -0,0 +1,327 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dimmer.c
+// history:   2026-10-17 V0.1 start
+//            2026-10-17 V0.2 the ISRs enable the interrupts at once: the
+//                            edge receiver takes its timestamp in software
+//
+//------------------------------------------------------------------------
+//
+// purpose:   flexible general purpose decoder for dcc
+//            here: soft PWM dimmer for the 8 outputs (CV33 MODE = 4)
+//
+//            Every output has a level 0..255 (0 = off, 255 = on). The
+//            PWM runs on timer0 (normal mode, prescaler 64: 8us per count,
+//            period 2.048ms = 488Hz); the on time of an output is 'level'
+//            counts.
+//
+//            Timer0 is free with ALTERNATE_RECEIVE 2 (the receiver uses
+//            INT0 and TCNT1), so the dimmer requires this receiver and
+//            no RailCom; timer1 stays with the servos and the 20ms tick.
+//
+//            Instead of one interrupt per count, the outputs are switched
+//            from a schedule sorted by level:
+//              TIMER0_OVF:  swap in a new schedule, if one is pending;
+//                           all outputs with level > 0 are turned on
+//              TIMER0_COMP: the outputs of the next entry are turned off,
+//                           OCR0 is set to the entry after it
+//            Outputs with the same level share one entry; level 255 has
+//            no entry (on for the whole period). So there are at most
+//            9 interrupts per period, whatever the levels are.
+//            If the next entry is due within one count, it is done at
+//            once (OCR0 would not match in time).
+//
+//            The edge receiver (INT0) reads TCNT1 in software; an ISR that
+//            blocks it shifts the timestamp of a dcc edge (dcc_receiver.c,
+//            tools/isr_budget.txt: at most 40 cycles). So both ISRs mask
+//            the timer0 interrupts and the timetick (TOIE1, up to 0.5ms)
+//            and enable the interrupts at once. INT0 may come in and
+//            delays an output by up to its own run time (~46us, 6 counts),
+//            as before. The check of an entry against TCNT0 and the write
+//            of OCR0 run with cli, otherwise an INT0 in between could let
+//            the match pass.
+//
+//            The schedule is built in the main loop, when a level has
+//            changed, into the second buffer; the ISR takes it at the
+//            next period. So the ISR never sees a half built schedule.
+//
+//            run_dimmer() fades each output towards its target: 'rate'
+//            steps per timetick (20ms), rate 0 = at once.
+//
+//            Accessory commands (like direct_action):
+//              Command = 2*n   output n off (fade to 0)
+//              Command = 2*n+1 output n on  (fade to Dim_Level[n])
+//            The fade rate is Dim_Rate[n]. Outputs on/off are saved in
+//            LastState and faded in again after reset.
+//
+//------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>        // put var to program memory
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "config.h"
+#include "myeeprom.h"            // wrapper for eeprom
+#include "hardware.h"
+#include "main.h"
+#include "dimmer.h"
+
+#if (DIMMER_ENABLED == TRUE)
+
+typedef struct
+  {
+    unsigned char on;                   // outputs with level > 0
+    unsigned char count;                // entries in time[], off[]
+    unsigned char time[DIMMER_OUTPUTS]; // TCNT0 to turn off, ascending
+    unsigned char off[DIMMER_OUTPUTS];  // outputs to turn off at time[]
+  } t_dimm_schedule;
+
+typedef struct
+  {
+    unsigned char level;                // current pwm value
+    unsigned char target;               // fading to
+    unsigned char rate;                 // steps per tick, 0 = at once
+  } t_dimm_out;
+
+static t_dimm_out dimm[DIMMER_OUTPUTS];
+
+static volatile t_dimm_schedule schedule[2];
+static volatile unsigned char active;   // schedule used by the ISR
+static volatile unsigned char pending;  // 1: the other schedule is new
+static unsigned char next;              // ISR: next entry of the schedule
+
+static unsigned char dimm_changed;      // a level has changed, schedule is old
+static signed char last_dimm_run;       // timerval of the last fade step
+
+
+//---------------------------------------------------------------------------
+// ISR
+
+#define DIMMER_MASK  ((1<<TOIE0) | (1<<OCIE0) | (1<<TOIE1))
+
+// mask the timer0 interrupts and the timetick, then allow INT0;
+// returns the bits to restore (TOIE1 is already off within INT0)
+static inline unsigned char dimmer_unblock(void) __attribute__((always_inline));
+unsigned char dimmer_unblock(void)
+  {
+    unsigned char mask;
+
+    mask = TIMSK & DIMMER_MASK;
+    TIMSK &= ~DIMMER_MASK;
+    sei();
+    return(mask);
+  }
+
+// turn off all entries up to the current count, program the next one
+static inline void dimmer_off(volatile t_dimm_schedule *s)
+  {
+    while (next < s->count)
+      {
+        cli();
+        if (s->time[next] > TCNT0 + 1)
+          {
+            OCR0 = s->time[next];
+            sei();
+            return;
+          }
+        sei();
+        OUTPUT_PORT &= ~s->off[next];
+        next++;
+      }
+  }
+
+ISR(TIMER0_OVF_vect)
+  {
+    unsigned char mask;
+
+    mask = dimmer_unblock();
+    if (pending)
+      {
+        active ^= 1;
+        pending = 0;
+      }
+    OUTPUT_PORT = schedule[active].on;
+    next = 0;
+    dimmer_off(&schedule[active]);
+    cli();
+    TIMSK |= mask;
+  }
+
+ISR(TIMER0_COMP_vect)
+  {
+    unsigned char mask;
+
+    mask = dimmer_unblock();
+    dimmer_off(&schedule[active]);
+    cli();
+    TIMSK |= mask;
+  }
+
+
+//---------------------------------------------------------------------------
+// schedule
+
+// sort the outputs by level into the schedule which is not in use
+static void dimmer_schedule(void)
+  {
+    volatile t_dimm_schedule *s = &schedule[active ^ 1];
+    unsigned char i, j, k, level, mask;
+
+    s->on = 0;
+    s->count = 0;
+    for (i=0, mask=1; i<DIMMER_OUTPUTS; i++, mask<<=1)
+      {
+        level = dimm[i].level;
+        if (level == 0) continue;
+        s->on |= mask;
+        if (level == 255) continue;                 // on for the whole period
+
+        for (j=0; j<s->count; j++)
+          {
+            if (s->time[j] >= level) break;
+          }
+        if ((j < s->count) && (s->time[j] == level))
+          {
+            s->off[j] |= mask;                      // same level, same entry
+            continue;
+          }
+        for (k=s->count; k>j; k--)
+          {
+            s->time[k] = s->time[k-1];
+            s->off[k] = s->off[k-1];
+          }
+        s->time[j] = level;
+        s->off[j] = mask;
+        s->count++;
+      }
+    pending = 1;
+  }
+
+
+//---------------------------------------------------------------------------
+// init, action
+
+void dimmer_set(unsigned char output, unsigned char level, unsigned char rate)
+  {
+    if (output >= DIMMER_OUTPUTS) return;
+    dimm[output].target = level;
+    dimm[output].rate = rate;
+    if (rate == 0)
+      {
+        dimm[output].level = level;
+        dimm_changed = 1;
+      }
+  }
+
+void init_dimmer(void)
+  {
+    unsigned char i, last_state;
+
+    last_state = my_eeprom_read_byte(&CV.LastState);
+    for (i=0; i<DIMMER_OUTPUTS; i++)
+      {
+        dimm[i].level = 0;
+        dimm[i].target = 0;
+        if (last_state & (1<<i))                    // fade in again
+          {
+            dimmer_set(i, my_eeprom_read_byte(&CV.Dim_Level[i]),
+                          my_eeprom_read_byte(&CV.Dim_Rate[i]));
+          }
+      }
+    PortState = last_state;
+
+    OUTPUT_PORT = 0;
+    active = 0;
+    pending = 0;
+    next = 0;
+    schedule[0].on = 0;
+    schedule[0].count = 0;
+    dimm_changed = 1;
+    last_dimm_run = timerval;
+
+    TCCR0 = (0 << FOC0)         // Timer0: normal mode
+          | (0 << WGM00)        // wgm = 00: normal, top = 0xFF
+          | (0 << COM01)        // com = 00: pin operates as usual
+          | (0 << COM00)
+          | (0 << WGM01)
+          | (0 << CS02)         // cs = 011: clk/64 -> 8us per count
+          | (1 << CS01)
+          | (1 << CS00);
+    TCNT0 = 0;
+    TIMSK |= (1<<TOIE0)         // Timer0 Overflow: outputs on
+          |  (1<<OCIE0);        // Timer0 Compare: outputs off
+  }
+
+void dimmer_action(unsigned int Command)
+  {
+    unsigned char output;
+
+    if (Command >= 2 * DIMMER_OUTPUTS) return;      // not our Address
+    output = Command >> 1;
+
+    if (Command & 1)
+      {
+        dimmer_set(output, my_eeprom_read_byte(&CV.Dim_Level[output]),
+                           my_eeprom_read_byte(&CV.Dim_Rate[output]));
+        PortState |= (1<<output);
+      }
+    else
+      {
+        dimmer_set(output, 0, my_eeprom_read_byte(&CV.Dim_Rate[output]));
+        PortState &= ~(1<<output);
+      }
+    semaphor_set(C_DoSave);
+  }
+
+
+//---------------------------------------------------------------------------
+// main loop
+
+void run_dimmer(void)
+  {
+    unsigned char i, level, target, rate;
+
+    if (timerval != last_dimm_run)
+      {
+        last_dimm_run = timerval;
+        for (i=0; i<DIMMER_OUTPUTS; i++)
+          {
+            level = dimm[i].level;
+            target = dimm[i].target;
+            if (level == target) continue;
+            rate = dimm[i].rate;
+            if (target > level)
+              {
+                if ((rate == 0) || (target - level <= rate)) level = target;
+                else level += rate;
+              }
+            else
+              {
+                if ((rate == 0) || (level - target <= rate)) level = target;
+                else level -= rate;
+              }
+            dimm[i].level = level;
+            dimm_changed = 1;
+          }
+      }
+
+    if (dimm_changed && !pending)       // the ISR has taken the last one
+      {
+        dimm_changed = 0;
+        dimmer_schedule();
+      }
+  }
+
+#endif // (DIMMER_ENABLED == TRUE)
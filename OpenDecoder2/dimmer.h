@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dimmer.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   soft PWM dimmer for the outputs (mode 4), see dimmer.c
+//
+// howto:     Step 1: set CV33 (MODE) to 4; brightness and fade rate of
+//                    each output in Dim_Level1..8 and Dim_Rate1..8
+//            Step 2: call init_dimmer() - starts timer0
+//            Step 3: accessory commands to dimmer_action(), like
+//                    direct_action(): command 2*n turns output n off,
+//                    2*n+1 turns it on (fading to Dim_Level)
+//            Step 4: call run_dimmer() in the main loop (fading)
+//
+//------------------------------------------------------------------------
+#ifndef _DIMMER_H_
+#define _DIMMER_H_
+
+#define DIMMER_MODE     4           // CV.MODE of the dimmer
+#define DIMMER_OUTPUTS  8           // bits of OUTPUT_PORT
+
+void init_dimmer(void);
+
+void dimmer_action(unsigned int Command);
+
+// fade output to level (0: off, 255: full on), rate: steps per tick, 0: at once
+void dimmer_set(unsigned char output, unsigned char level, unsigned char rate);
+
+void run_dimmer(void);
+
+#endif // _DIMMER_H_
@@ -1082,7 +1082,7 @@ void copy_preset_to_eeprom(unsigned char index)
             _mydelay_us(1000L);
           }
       }
-    do {} while (!eeprom_is_ready());    // wait for write to complete
+    my_eeprom_flush();                   // wait for write to complete
     turn_led_on();
     for (i=0; i < 1000; i++)
       {
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      fn_decoder.c
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   flexible general purpose decoder for dcc
+//            here: function decoder (CV33 MODE = 48)
+//
+//            The decoder listens to a loco address (CV11/12, like CV17/18:
+//            CV11 = 0 -> short address in CV12). analyze_message() decodes
+//            speed, direction and the functions F0..F28 of this address
+//            into 'loco' and returns 4 if something has changed.
+//            fn_action() then runs through the mapping table fn_map[] and
+//            performs the action of every entry whose function has changed:
+//
+//              FN_OUTPUT   output follows the function
+//              FN_SERVO    servo moves like the accessory command 2*nr + on
+//              FN_RGB      rgb_action(param) when the function turns on
+//
+//            Besides F0..F28 the table can use FN_BIT_FORWARD (direction)
+//            and FN_BIT_MOVING (speed > 0), e.g. for direction dependent
+//            lights.
+//
+//            fn_map[] is in RAM; it is loaded from fn_map_preset at init
+//            and may be changed at runtime.
+//
+//------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>        // put var to program memory
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "config.h"
+#include "hardware.h"
+#include "dcc_receiver.h"
+#include "dcc_decode.h"
+#include "main.h"
+#include "servo.h"
+#include "rgb.h"
+#include "fn_decoder.h"
+
+#if (FUNCTION_ENABLED == TRUE)
+
+t_fn_map fn_map[FN_MAP_SIZE];
+
+static unsigned long fn_done;           // functions as already performed
+
+static const t_fn_map fn_map_preset[FN_MAP_SIZE] PROGMEM =
+  {
+    {  0,             FN_OUTPUT, 0 },   // F0 (light) -> output 0
+    {  1,             FN_OUTPUT, 1 },
+    {  2,             FN_OUTPUT, 2 },
+    {  3,             FN_OUTPUT, 3 },
+    {  4,             FN_OUTPUT, 4 },
+    {  5,             FN_OUTPUT, 5 },
+    {  6,             FN_OUTPUT, 6 },
+    {  7,             FN_OUTPUT, 7 },
+    #if (SERVO_ENABLED == TRUE)
+    {  8,             FN_SERVO,  0 },
+    {  9,             FN_SERVO,  1 },
+    #else
+    {  0,             FN_NONE,   0 },
+    {  0,             FN_NONE,   0 },
+    #endif
+    #if (RGB_ENABLED == TRUE)
+    { 10,             FN_RGB,    1 },   // fade
+    { 11,             FN_RGB,    0 },   // stop fade
+    #else
+    {  0,             FN_NONE,   0 },
+    {  0,             FN_NONE,   0 },
+    #endif
+  };
+
+
+void init_fn_decoder(void)
+  {
+    unsigned char i;
+
+    for (i=0; i<FN_MAP_SIZE; i++)
+      {
+        fn_map[i].function = pgm_read_byte(&fn_map_preset[i].function);
+        fn_map[i].action   = pgm_read_byte(&fn_map_preset[i].action);
+        fn_map[i].param    = pgm_read_byte(&fn_map_preset[i].param);
+      }
+    fn_done = 0;                        // all outputs are off after reset
+  }
+
+
+void fn_action(void)
+  {
+    unsigned long changed;
+    unsigned char i, on;
+
+    changed = loco.functions ^ fn_done;
+    if (changed == 0) return;           // speed only
+
+    for (i=0; i<FN_MAP_SIZE; i++)
+      {
+        if (!(changed & (1UL << fn_map[i].function))) continue;
+        on = (loco.functions & (1UL << fn_map[i].function)) != 0;
+
+        switch(fn_map[i].action)
+          {
+            case FN_OUTPUT:
+                if (on) OUTPUT_PORT |= (1 << fn_map[i].param);
+                else    OUTPUT_PORT &= ~(1 << fn_map[i].param);
+                PortState = OUTPUT_PORT;
+                break;
+            #if (SERVO_ENABLED == TRUE)
+            case FN_SERVO:
+                servo_action(fn_map[i].param * 2 + on);
+                break;
+            #endif
+            #if (RGB_ENABLED == TRUE)
+            case FN_RGB:
+                if (on) rgb_action(fn_map[i].param);
+                break;
+            #endif
+            default:
+                break;
+          }
+      }
+    fn_done = loco.functions;
+  }
+
+#endif // (FUNCTION_ENABLED == TRUE)
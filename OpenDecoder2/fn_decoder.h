@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      fn_decoder.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   function decoder (mode 48), see fn_decoder.c
+//
+// howto:     Step 1: set CV11/CV12 (FnAddrH, FnAddrL) to the loco address
+//                    and CV33 (MODE) to 48
+//            Step 2: call init_fn_decoder()
+//            Step 3: if analyze_message() returns 4, call fn_action()
+//
+//------------------------------------------------------------------------
+#ifndef _FN_DECODER_H_
+#define _FN_DECODER_H_
+
+#define FN_MODE         48          // CV.MODE of the function decoder
+
+// actions of the mapping table
+#define FN_NONE         0
+#define FN_OUTPUT       1           // param: bit of OUTPUT_PORT, on with the function
+#define FN_SERVO        2           // param: servo (0, 1); off -> command 2*nr, on -> 2*nr+1
+#define FN_RGB          3           // param: rgb_action command, sent when turned on
+
+typedef struct
+  {
+    unsigned char function;         // 0..28: F0..F28, or FN_BIT_FORWARD, FN_BIT_MOVING
+    unsigned char action;           // FN_x
+    unsigned char param;
+  } t_fn_map;
+
+#define FN_MAP_SIZE     12
+
+extern t_fn_map fn_map[FN_MAP_SIZE];    // RAM, loaded with a preset in init_fn_decoder()
+
+void init_fn_decoder(void);
+
+void fn_action(void);                   // apply the changes of 'loco' (dcc_decode.h)
+
+#endif // _FN_DECODER_H_
@@ -18,6 +18,8 @@
 //            2007-05-21 V0.2 kw added OpenDecoder3
 //            2008-09-28 V0.3 kw added OpenDecoder25
 //            2011-11-30 V0.4 kw added OpenDecoder28
+//            2026-10-17          OpenDecoder3: JUMPER_FITTED, servo power
+//                                and RailCom LED macros
 //------------------------------------------------------------------------
 //
 // purpose:   flexible general purpose decoder for dcc
@@ -464,8 +466,11 @@
 
 #define PROG_PRESSED    (!(PIND & (1<<PROGTASTER)))
 #define JUMPER2_FITTED  (!(PIND & (1<<JUMPER2)))
+#define JUMPER_FITTED   JUMPER2_FITTED              // map standard Jumper to Jumper2
 #define DCC_ACK_OFF     PORTD &= ~(1<<DCC_ACK)
 #define DCC_ACK_ON      PORTD |= (1<<DCC_ACK)
+#define RAILCOM_LED_OFF PORTD &= ~(1<<RAILCOM_ON)
+#define RAILCOM_LED_ON  PORTD |= (1<<RAILCOM_ON)
 
 
 // PORTE:
@@ -474,6 +479,11 @@
 #define SERVO2          2       // output (OC1B)
 #define JUMPER1_FITTED  (!(PINE & (1<<JUMPER1)))
 
+#define SERVO1_POWER_ON                             // no power switch on this board
+#define SERVO1_POWER_OFF
+#define SERVO2_POWER_ON
+#define SERVO2_POWER_OFF
+
 
 //----------------------------------------------------------------------------
 //
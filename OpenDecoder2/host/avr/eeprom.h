@@ -0,0 +1,37 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/avr/eeprom.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <avr/eeprom.h> on the host build
+//            EEMEM variables are collected in the section host_eeprom,
+//            access is done in host_hal.c with the timing of the AVR
+//            (a write blocks the next access for EEPROM_WRITE_TIME).
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_AVR_EEPROM_H_
+#define _HOST_AVR_EEPROM_H_
+
+#include <stdint.h>
+
+#define EEMEM   __attribute__((section("host_eeprom"), aligned(1)))
+
+uint8_t eeprom_read_byte(const uint8_t *__p);
+
+void eeprom_write_byte(uint8_t *__p, uint8_t __value);
+
+uint8_t eeprom_is_ready(void);
+
+#define eeprom_busy_wait()  do {} while (!eeprom_is_ready())
+
+#endif // _HOST_AVR_EEPROM_H_
@@ -0,0 +1,34 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/avr/interrupt.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <avr/interrupt.h> on the host build
+//            ISR(vector) becomes a plain function with the name of
+//            the vector; host_hal.c calls it when the simulated event
+//            is due and the I-bit in SREG is set.
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_AVR_INTERRUPT_H_
+#define _HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)    void vector(void); void vector(void)
+
+#define cli()               do { SREG &= ~(1<<SREG_I); } while(0)
+#define sei()               host_sei()
+
+void host_sei(void);
+
+#endif // _HOST_AVR_INTERRUPT_H_
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/avr/io.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <avr/io.h> on the host build
+//            every register is a plain variable (see host_hal.c);
+//            register set and bit positions are those of the ATmega8515
+//            and ATmega162 (OC2, timer 3 and 2nd uart).
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_AVR_IO_H_
+#define _HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit)        (1 << (bit))
+
+//------------------------------------------------------------------------
+// registers
+
+extern volatile uint8_t  SREG;
+
+extern volatile uint8_t  PORTA, DDRA, PINA;
+extern volatile uint8_t  PORTB, DDRB, PINB;
+extern volatile uint8_t  PORTC, DDRC, PINC;
+extern volatile uint8_t  PORTD, DDRD, PIND;
+extern volatile uint8_t  PORTE, DDRE, PINE;
+
+extern volatile uint8_t  MCUCR, EMCUCR, MCUCSR, GICR, GIFR;
+extern volatile uint8_t  TIMSK, TIFR, ETIMSK, ETIFR;
+
+extern volatile uint8_t  TCCR0, TCNT0, OCR0;
+extern volatile uint8_t  TCCR1A, TCCR1B;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+extern volatile uint8_t  TCCR2, TCNT2, OCR2;
+extern volatile uint8_t  TCCR3A, TCCR3B;
+extern volatile uint16_t TCNT3, OCR3A, OCR3B, ICR3;
+
+extern volatile uint8_t  UDR, UCSRA, UCSRB, UCSRC, UBRRL, UBRRH;
+extern volatile uint8_t  UDR0, UCSR0A, UCSR0B, UCSR0C, UBRR0L, UBRR0H;
+extern volatile uint8_t  UDR1, UCSR1A, UCSR1B, UCSR1C, UBRR1L, UBRR1H;
+
+extern volatile uint8_t  SPDR, SPSR, SPCR;
+extern volatile uint8_t  EEARL, EEARH, EEDR, EECR;
+extern volatile uint8_t  WDTCR, OSCCAL;
+
+#define OCR1AL  (*(volatile uint8_t *) &OCR1A)
+#define OCR1BL  (*(volatile uint8_t *) &OCR1B)
+
+//------------------------------------------------------------------------
+// bit positions
+
+#define SREG_I  7
+
+// ports
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+#define PE0 0
+#define PE1 1
+#define PE2 2
+
+// MCUCR
+#define SRE     7
+#define SRW10   6
+#define SE      5
+#define SM1     4
+#define ISC11   3
+#define ISC10   2
+#define ISC01   1
+#define ISC00   0
+
+// GICR
+#define INT1    7
+#define INT0    6
+#define INT2    5
+#define IVSEL   1
+#define IVCE    0
+
+// TIMSK
+#define TOIE1   7
+#define OCIE1A  6
+#define OCIE1B  5
+#define OCIE2   4
+#define TICIE1  3
+#define TOIE2   2
+#define TOIE0   1
+#define OCIE0   0
+
+// TIFR
+#define TOV1    7
+#define OCF1A   6
+#define OCF1B   5
+#define OCF2    4
+#define ICF1    3
+#define TOV2    2
+#define TOV0    1
+#define OCF0    0
+
+// ETIMSK
+#define TICIE3  5
+#define OCIE3A  4
+#define OCIE3B  3
+#define TOIE3   2
+
+// TCCR0
+#define FOC0    7
+#define WGM00   6
+#define COM01   5
+#define COM00   4
+#define WGM01   3
+#define CS02    2
+#define CS01    1
+#define CS00    0
+
+// TCCR1A
+#define COM1A1  7
+#define COM1A0  6
+#define COM1B1  5
+#define COM1B0  4
+#define FOC1A   3
+#define FOC1B   2
+#define WGM11   1
+#define WGM10   0
+
+// TCCR1B
+#define ICNC1   7
+#define ICES1   6
+#define WGM13   4
+#define WGM12   3
+#define CS12    2
+#define CS11    1
+#define CS10    0
+
+// TCCR2
+#define FOC2    7
+#define WGM20   6
+#define COM21   5
+#define COM20   4
+#define WGM21   3
+#define CS22    2
+#define CS21    1
+#define CS20    0
+
+// TCCR3A, TCCR3B
+#define COM3A1  7
+#define COM3A0  6
+#define COM3B1  5
+#define COM3B0  4
+#define FOC3A   3
+#define FOC3B   2
+#define WGM31   1
+#define WGM30   0
+#define ICNC3   7
+#define ICES3   6
+#define WGM33   4
+#define WGM32   3
+#define CS32    2
+#define CS31    1
+#define CS30    0
+
+// UCSRA, UCSRB, UCSRC (also UCSRnx)
+#define RXC     7
+#define TXC     6
+#define UDRE    5
+#define FE      4
+#define DOR     3
+#define PE      2
+#define U2X     1
+#define MPCM    0
+#define RXCIE   7
+#define TXCIE   6
+#define UDRIE   5
+#define RXEN    4
+#define TXEN    3
+#define UCSZ2   2
+#define RXB8    1
+#define TXB8    0
+#define URSEL   7
+#define UMSEL   6
+#define UPM1    5
+#define UPM0    4
+#define USBS    3
+#define UCSZ1   2
+#define UCSZ0   1
+#define UCPOL   0
+#define TXC0    6               // mega162 names of UART0
+#define UDRE0   5
+#define TXEN0   3
+#define URSEL0  7
+#define USBS0   3
+#define UCSZ01  2
+#define UCSZ00  1
+
+// EECR
+#define EERIE   3
+#define EEMWE   2
+#define EEWE    1
+#define EERE    0
+
+// WDTCR
+#define WDCE    4
+#define WDE     3
+#define WDP2    2
+#define WDP1    1
+#define WDP0    0
+
+#endif // _HOST_AVR_IO_H_
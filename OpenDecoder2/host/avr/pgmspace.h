@@ -0,0 +1,36 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/avr/pgmspace.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <avr/pgmspace.h> on the host build
+//            flash constants are ordinary const data.
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_AVR_PGMSPACE_H_
+#define _HOST_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+
+#define PGM_P               const char *
+#define PGM_VOID_P          const void *
+#define PSTR(s)             (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define memcpy_P(d, s, n)    memcpy((d), (s), (n))
+
+#endif // _HOST_AVR_PGMSPACE_H_
@@ -0,0 +1,25 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/avr/sleep.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <avr/sleep.h> on the host build
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_AVR_SLEEP_H_
+#define _HOST_AVR_SLEEP_H_
+
+#define set_sleep_mode(mode)
+#define sleep_mode()        host_poll()
+
+#endif // _HOST_AVR_SLEEP_H_
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dcc_gen.c
+// history:   2026-10-17 V0.1 start (from the SIMULATION 2 generator of main.c)
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2
+//            dcc bitstream generator
+//
+//            A packet is sent as preamble, start bit, data bytes (each
+//            with a leading '0'), XOR and the end bit '1'. Every bit is
+//            two half bits; the generator hands them to a sink, e.g.
+//            host_dcc_halfbit().
+//
+//            Signal errors, all reproducible with the seed:
+//              jitter:  each half bit is changed by a random value in
+//                       -jitter..+jitter us
+//              stretch: the first half of each '0' is longer by stretch
+//                       us (zero stretching of the command station)
+//              glitch:  in average every glitch_rate half bits, a half
+//                       bit is split by a pulse of glitch_len us (two
+//                       extra edges, the level afterwards is unchanged)
+//              cutout:  after the end bit, the track is switched off
+//                       (DCC_GEN_CUTOUT_START, then DCC_GEN_CUTOUT us)
+//
+//------------------------------------------------------------------------
+
+#include <stdlib.h>
+
+#include "dcc_gen.h"
+
+// xorshift32 - same sequence on every host
+static uint32_t gen_random(t_dcc_gen *gen)
+  {
+    uint32_t x = gen->seed;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    gen->seed = x;
+    return(x);
+  }
+
+void dcc_gen_init(t_dcc_gen *gen, void (*sink)(uint16_t duration_us))
+  {
+    gen->preamble = DCC_GEN_PREAMBLE;
+    gen->one_half = DCC_GEN_ONE_HALF;
+    gen->zero_half = DCC_GEN_ZERO_HALF;
+    gen->cutout = 0;
+    gen->jitter = 0;
+    gen->stretch = 0;
+    gen->glitch_rate = 0;
+    gen->glitch_len = 2;
+    gen->seed = 1;
+    gen->sink = sink;
+    gen->packets = 0;
+    gen->bits = 0;
+    gen->glitches = 0;
+  }
+
+static void gen_halfbit(t_dcc_gen *gen, long t)
+  {
+    if (gen->jitter)
+      {
+        t += (long)(gen_random(gen) % (2 * gen->jitter + 1)) - gen->jitter;
+      }
+    if (t < 1) t = 1;
+    if (t > 0xFFFF) t = 0xFFFF;
+
+    if (gen->glitch_rate && (gen_random(gen) % gen->glitch_rate == 0)
+        && (t > gen->glitch_len + 1))
+      {
+        long before = 1 + gen_random(gen) % (t - gen->glitch_len);
+
+        gen->sink(before);
+        gen->sink(gen->glitch_len);
+        t -= before + gen->glitch_len;
+        if (t < 1) t = 1;
+        gen->glitches++;
+      }
+    gen->sink(t);
+  }
+
+void dcc_gen_bit(t_dcc_gen *gen, unsigned char bit)
+  {
+    if (bit)
+      {
+        gen_halfbit(gen, gen->one_half);
+        gen_halfbit(gen, gen->one_half);
+      }
+    else
+      {
+        gen_halfbit(gen, (long)gen->zero_half + gen->stretch);
+        gen_halfbit(gen, gen->zero_half);
+      }
+    gen->bits++;
+  }
+
+void dcc_gen_packet(t_dcc_gen *gen, const unsigned char *data, unsigned char size)
+  {
+    unsigned char i, j, xor = 0;
+
+    for (i=0; i<gen->preamble; i++) dcc_gen_bit(gen, 1);
+    for (i=0; i<=size; i++)
+      {
+        unsigned char b = (i < size) ? data[i] : xor;
+        dcc_gen_bit(gen, 0);
+        for (j=0; j<8; j++) dcc_gen_bit(gen, b & (0x80 >> j));
+        xor ^= b;
+      }
+    dcc_gen_bit(gen, 1);
+    if (gen->cutout)
+      {
+        gen->sink(DCC_GEN_CUTOUT_START);
+        gen->sink(DCC_GEN_CUTOUT);
+      }
+    gen->packets++;
+  }
@@ -0,0 +1,69 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dcc_gen.h
+// history:   2026-10-17 V0.1 start (from the SIMULATION 2 generator of main.c)
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2
+//            dcc bitstream generator: packets -> timed half bits
+//
+// howto:     Step 1: dcc_gen_init(&gen, sink) - nominal timing, 14 bit
+//                    preamble, no errors
+//            Step 2: change the parameters of gen as required
+//            Step 3: dcc_gen_packet() for each packet; every half bit
+//                    is passed to sink (in us).
+//
+//------------------------------------------------------------------------
+#ifndef _DCC_GEN_H_
+#define _DCC_GEN_H_
+
+#include <stdint.h>
+
+#define DCC_GEN_ONE_HALF     58         // us
+#define DCC_GEN_ZERO_HALF    100        // us
+#define DCC_GEN_PREAMBLE     14         // bits
+#define DCC_GEN_CUTOUT_START 29         // us after the end bit (26..32)
+#define DCC_GEN_CUTOUT       435        // us without edge (454..488 incl. start)
+
+typedef struct
+  {
+    // timing
+    unsigned char preamble;             // '1' bits before the packet
+    uint16_t one_half;                  // us
+    uint16_t zero_half;                 // us
+    unsigned char cutout;               // railcom cutout after the end bit
+
+    // signal errors
+    uint16_t jitter;                    // each half bit +/- 0..jitter us
+    uint16_t stretch;                   // first half of each '0' is longer (zero stretching)
+    unsigned long glitch_rate;          // one glitch in glitch_rate half bits, 0: off
+    uint16_t glitch_len;                // us, the half bit is split by a short pulse
+
+    uint32_t seed;                      // random generator for jitter and glitches
+
+    // output
+    void (*sink)(uint16_t duration_us);
+
+    // statistics
+    unsigned long packets;
+    unsigned long bits;
+    unsigned long glitches;
+  } t_dcc_gen;
+
+void dcc_gen_init(t_dcc_gen *gen, void (*sink)(uint16_t duration_us));
+
+// data without XOR (is appended here)
+void dcc_gen_packet(t_dcc_gen *gen, const unsigned char *data, unsigned char size);
+
+void dcc_gen_bit(t_dcc_gen *gen, unsigned char bit);
+
+#endif // _DCC_GEN_H_
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dcc_trace.c
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2
+//            binary trace of received dcc messages, see dcc_trace.h
+//
+//------------------------------------------------------------------------
+
+#include <string.h>
+
+#include "dcc_trace.h"
+
+static const char magic[4] = { 'D', 'C', 'C', 'T' };
+
+int dcc_trace_write_header(FILE *f)
+  {
+    if (fwrite(magic, sizeof(magic), 1, f) != 1) return(-2);
+    if (fputc(DCC_TRACE_VERSION, f) == EOF) return(-2);
+    return(0);
+  }
+
+int dcc_trace_write(FILE *f, uint64_t *last_us, const t_dcc_trace_rec *rec)
+  {
+    uint64_t delta = rec->time_us - *last_us;
+
+    if ((rec->size == 0) || (rec->size > DCC_TRACE_MAX_SIZE)) return(-2);
+
+    do
+      {
+        unsigned char b = delta & 0x7F;
+        delta >>= 7;
+        if (delta) b |= 0x80;
+        fputc(b, f);
+      }
+    while (delta);
+
+    fputc(rec->size, f);
+    if (fwrite(rec->dcc, rec->size, 1, f) != 1) return(-2);
+    *last_us = rec->time_us;
+    return(0);
+  }
+
+int dcc_trace_read_header(FILE *f)
+  {
+    char head[4];
+
+    if (fread(head, sizeof(head), 1, f) != 1) return(-2);
+    if (memcmp(head, magic, sizeof(magic))) return(-2);
+    if (fgetc(f) != DCC_TRACE_VERSION) return(-2);
+    return(0);
+  }
+
+int dcc_trace_read(FILE *f, uint64_t *last_us, t_dcc_trace_rec *rec)
+  {
+    uint64_t delta = 0;
+    unsigned char shift = 0;
+    int c;
+
+    do
+      {
+        c = fgetc(f);
+        if (c == EOF) return(shift ? -2 : -1);
+        if (shift > 56) return(-2);
+        delta |= (uint64_t)(c & 0x7F) << shift;
+        shift += 7;
+      }
+    while (c & 0x80);
+
+    c = fgetc(f);
+    if ((c == EOF) || (c == 0) || (c > DCC_TRACE_MAX_SIZE)) return(-2);
+    rec->size = c;
+    if (fread(rec->dcc, rec->size, 1, f) != 1) return(-2);
+    *last_us += delta;
+    rec->time_us = *last_us;
+    return(0);
+  }
@@ -0,0 +1,50 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      dcc_trace.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2
+//            binary trace of received dcc messages
+//
+// format:    header:  "DCCT", version (1 byte)
+//            record:  time since the previous record in us (LEB128:
+//                     7 bits per byte, low bits first, bit 7 = more),
+//                     size (1 byte, 3..6 incl. XOR), dcc bytes
+//
+//            An accessory command 1..2 ms apart takes 6 bytes.
+//
+//------------------------------------------------------------------------
+#ifndef _DCC_TRACE_H_
+#define _DCC_TRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define DCC_TRACE_VERSION   1
+#define DCC_TRACE_MAX_SIZE  6           // = MAX_DCC_SIZE
+
+typedef struct
+  {
+    uint64_t time_us;                   // since the start of the trace
+    unsigned char size;
+    unsigned char dcc[DCC_TRACE_MAX_SIZE];
+  } t_dcc_trace_rec;
+
+// all return 0 on success
+int dcc_trace_write_header(FILE *f);
+int dcc_trace_write(FILE *f, uint64_t *last_us, const t_dcc_trace_rec *rec);
+
+int dcc_trace_read_header(FILE *f);
+int dcc_trace_read(FILE *f, uint64_t *last_us, t_dcc_trace_rec *rec);   // -1: end of file
+
+#endif // _DCC_TRACE_H_
@@ -0,0 +1,673 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host_hal.c
+// history:   2026-10-17 V0.1 start
+//            2026-10-17          duty cycle of the outputs (PORTB)
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2 - simulated hardware
+//
+// howto:     The decoder code runs unchanged; all registers are plain
+//            variables. Time is counted in cpu cycles and advanced only
+//            here, from one event to the next:
+//              - dcc half bit edges from the stimulus (toggle DCCIN, a
+//                rising edge raises INT0)
+//              - timer0 overflow / compare match (normal and ctc mode;
+//                in normal mode the compare match is a separate event)
+//              - timer1 overflow (fast pwm, TOP = ICR1)
+//              - end of an eeprom write
+//            Bytes sent by host_uart_tx() are logged with their time.
+//            The ACK output (PD7 on OpenDecoder2/3) is watched at every
+//            event; pulses are counted.
+//            The on time of each bit of PORTB (outputs) is summed up in
+//            windows of 100ms (e.g. soft pwm of the dimmer).
+//            Messages taken by the main loop can be written to a trace
+//            file (dcc_trace.h).
+//            After each ISR and each return to the main loop the timer
+//            registers are compared with the last known state - a write
+//            by the decoder restarts the timer calculation.
+//            
+//            Pending interrupts are executed in AVR priority order
+//            (INT0, TIMER1_OVF, TIMER0_COMP, TIMER0_OVF), only if the
+//            I-bit in SREG is set; an ISR runs with I cleared.
+//
+// limits:    code itself takes no simulated time - only busy waits
+//            (_delay_loop_x, eeprom) and HOST_WAIT() advance the clock.
+//            int is 32 bit on the host.
+//
+//------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+
+#include "host_hal.h"
+#include "dcc_trace.h"
+
+#define TRUE    1
+#define FALSE   0
+
+#define NEVER   (~(t_host_time)0)
+
+#define EEPROM_WRITE_TIME   HOST_US(8500)   // tWD_EEPROM of mega8515
+
+//------------------------------------------------------------------------
+// registers
+
+volatile uint8_t  SREG;
+
+volatile uint8_t  PORTA, DDRA, PINA;
+volatile uint8_t  PORTB, DDRB, PINB;
+volatile uint8_t  PORTC, DDRC, PINC;
+volatile uint8_t  PORTD, DDRD, PIND;
+volatile uint8_t  PORTE, DDRE, PINE;
+
+volatile uint8_t  MCUCR, EMCUCR, MCUCSR, GICR, GIFR;
+volatile uint8_t  TIMSK, TIFR, ETIMSK, ETIFR;
+
+volatile uint8_t  TCCR0, TCNT0, OCR0;
+volatile uint8_t  TCCR1A, TCCR1B;
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint8_t  TCCR2, TCNT2, OCR2;
+volatile uint8_t  TCCR3A, TCCR3B;
+volatile uint16_t TCNT3, OCR3A, OCR3B, ICR3;
+
+volatile uint8_t  UDR, UCSRA, UCSRB, UCSRC, UBRRL, UBRRH;
+volatile uint8_t  UDR0, UCSR0A, UCSR0B, UCSR0C, UBRR0L, UBRR0H;
+volatile uint8_t  UDR1, UCSR1A, UCSR1B, UCSR1C, UBRR1L, UBRR1H;
+
+volatile uint8_t  SPDR, SPSR, SPCR;
+volatile uint8_t  EEARL, EEARH, EEDR, EECR;
+volatile uint8_t  WDTCR, OSCCAL;
+
+//------------------------------------------------------------------------
+// interrupt vectors of the decoder; missing ones are NULL
+
+void INT0_vect(void)         __attribute__((weak));
+void TIMER0_OVF_vect(void)   __attribute__((weak));
+void TIMER0_COMP_vect(void)  __attribute__((weak));
+void TIMER1_OVF_vect(void)   __attribute__((weak));
+
+static void (* const vectors[HOST_VEC_MAX])(void) =
+  {
+    [HOST_VEC_INT0]        = INT0_vect,
+    [HOST_VEC_TIMER0_OVF]  = TIMER0_OVF_vect,
+    [HOST_VEC_TIMER0_COMP] = TIMER0_COMP_vect,
+    [HOST_VEC_TIMER1_OVF]  = TIMER1_OVF_vect,
+  };
+
+// priority order of the AVR vector table
+static const unsigned char vector_order[HOST_VEC_MAX] =
+  {
+    HOST_VEC_INT0, HOST_VEC_TIMER1_OVF, HOST_VEC_TIMER0_COMP, HOST_VEC_TIMER0_OVF,
+  };
+
+//------------------------------------------------------------------------
+// simulation state
+
+static t_host_time now;
+static t_host_time end_time;
+static t_host_time runout = HOST_MS(100);
+static t_host_time start;
+
+static unsigned char pending;                   // bitfield of HOST_VEC_x
+static unsigned long isr_count[HOST_VEC_MAX];
+static t_host_time isr_cycles[HOST_VEC_MAX];
+
+typedef struct
+  {
+    uint8_t tccr;                               // last seen control
+    uint16_t tcnt;                              // last seen counter
+    uint16_t top;                               // last seen top
+    unsigned int prescaler;                     // 0 = stopped
+    t_host_time base;                           // time of tcnt == 0
+    t_host_time due;                            // next event
+    t_host_time cmp_due;                        // compare match in normal mode
+  } t_host_timer;
+
+static t_host_timer t0;
+static t_host_timer t1;
+
+static uint16_t *stimulus;                      // half bits in us
+static unsigned int stimulus_size;
+static unsigned int stimulus_len;
+static unsigned int stimulus_pos;
+static t_host_time stimulus_due;
+
+static t_host_time eeprom_ready;
+static unsigned long eeprom_writes;
+
+static t_host_time last_edge;                  // time of last DCCIN toggle
+
+static unsigned char ack_on;                    // DCC_ACK as last seen
+static t_host_time ack_start;
+static t_host_time ack_length;                  // of the last pulse
+static unsigned long ack_count;
+
+#define DUTY_WINDOW         HOST_MS(100)
+
+static unsigned char out_state;                 // PORTB as last seen
+static t_host_time out_since;                   // of out_state
+static t_host_time out_window;                  // start of the running window
+static t_host_time out_on[8];                   // running window
+static t_host_time out_duty[8];                 // last complete window
+static t_host_time out_duty_len;
+
+#define UART_BYTE_TIME      HOST_US(40)         // 10 bit at 250kBaud
+#define UART_LOG_SIZE       4096
+
+static t_host_uart uart_log[UART_LOG_SIZE];
+static unsigned int uart_count;
+static t_host_time uart_free;                   // end of last stop bit
+
+static FILE *trace_out;
+static uint64_t trace_last;                     // us, of the last record
+
+static jmp_buf restart_point;
+static unsigned char restarts;
+
+//------------------------------------------------------------------------
+// stimulus
+
+void host_dcc_halfbit(uint16_t duration_us)
+  {
+    if (stimulus_len == stimulus_size)
+      {
+        stimulus_size = stimulus_size ? 2 * stimulus_size : 4096;
+        stimulus = realloc(stimulus, stimulus_size * sizeof(stimulus[0]));
+        if (!stimulus)
+          {
+            perror("host_dcc_halfbit");
+            exit(1);
+          }
+      }
+    stimulus[stimulus_len++] = duration_us;
+  }
+
+unsigned int host_stimulus_length(void)
+  {
+    return(stimulus_len);
+  }
+
+void host_set_start(t_host_time delay)
+  {
+    start = delay;
+  }
+
+void host_set_runout(t_host_time extra)
+  {
+    runout = extra;
+  }
+
+static void do_stimulus(void)
+  {
+    unsigned char isc = MCUCR & ((1<<ISC01)|(1<<ISC00));
+
+    PIND ^= (1<<PD2);                           // DCCIN
+    last_edge = now;
+    if (GICR & (1<<INT0))
+      {
+        if (PIND & (1<<PD2))
+          {
+            if ((isc == 3) || (isc == 1)) pending |= (1<<HOST_VEC_INT0);   // rising, any
+          }
+        else
+          {
+            if ((isc == 2) || (isc == 1)) pending |= (1<<HOST_VEC_INT0);   // falling, any
+          }
+      }
+
+    stimulus_due += HOST_US(stimulus[stimulus_pos]);
+    stimulus_pos++;
+    if (stimulus_pos >= stimulus_len)
+      {
+        end_time = stimulus_due + runout;
+        stimulus_due = NEVER;
+      }
+  }
+
+//------------------------------------------------------------------------
+// timer
+
+static unsigned int t0_prescaler(uint8_t tccr)
+  {
+    static const unsigned int div[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+    return(div[tccr & 7]);
+  }
+
+static unsigned char t0_ctc(void)
+  {
+    return((TCCR0 & ((1<<WGM01)|(1<<WGM00))) == (1<<WGM01));
+  }
+
+// timer0: recalculate if the decoder has touched the registers
+static void sync_timer0(void)
+  {
+    unsigned int period;
+
+    if ((TCCR0 == t0.tccr) && (TCNT0 == t0.tcnt) && (OCR0 == t0.top))
+      {
+        if (t0.prescaler)                       // untouched: let it count
+          {
+            period = t0_ctc() ? OCR0 + 1 : 256;
+            TCNT0 = t0.tcnt = ((now - t0.base) / t0.prescaler) % period;
+          }
+        return;
+      }
+
+    t0.tccr = TCCR0;
+    t0.tcnt = TCNT0;
+    t0.top = OCR0;
+    t0.prescaler = t0_prescaler(TCCR0);
+    if (t0.prescaler == 0)
+      {
+        t0.due = t0.cmp_due = NEVER;
+        return;
+      }
+    t0.base = now - (t_host_time)TCNT0 * t0.prescaler;
+    if (t0_ctc() && (TCNT0 <= OCR0))
+        t0.due = t0.base + (t_host_time)(OCR0 + 1) * t0.prescaler;
+    else
+        t0.due = t0.base + (t_host_time)256 * t0.prescaler;
+
+    if (t0_ctc())
+        t0.cmp_due = NEVER;
+    else if (TCNT0 < OCR0)
+        t0.cmp_due = t0.base + (t_host_time)OCR0 * t0.prescaler;
+    else                                        // after the next overflow
+        t0.cmp_due = t0.base + (t_host_time)(256 + OCR0) * t0.prescaler;
+  }
+
+static void do_timer0_cmp(void)
+  {
+    if (TIMSK & (1<<OCIE0)) pending |= (1<<HOST_VEC_TIMER0_COMP);
+    t0.cmp_due += (t_host_time)256 * t0.prescaler;
+  }
+
+static void do_timer0(void)
+  {
+    if (t0_ctc() && (t0.tcnt <= t0.top))
+      {
+        if (TIMSK & (1<<OCIE0)) pending |= (1<<HOST_VEC_TIMER0_COMP);
+        t0.due += (t_host_time)(t0.top + 1) * t0.prescaler;
+      }
+    else
+      {
+        if (TIMSK & (1<<TOIE0)) pending |= (1<<HOST_VEC_TIMER0_OVF);
+        t0.due += (t_host_time)256 * t0.prescaler;
+      }
+    t0.base = now;
+    TCNT0 = t0.tcnt = 0;
+  }
+
+// timer1: only fast pwm with TOP = ICR1 (mode 14) is used by the decoder
+static void sync_timer1(void)
+  {
+    if ((TCCR1B == t1.tccr) && (TCNT1 == t1.tcnt) && (ICR1 == t1.top))
+      {
+        if (t1.prescaler)
+            TCNT1 = t1.tcnt = ((now - t1.base) / t1.prescaler) % ((unsigned long)ICR1 + 1);
+        return;
+      }
+
+    t1.tccr = TCCR1B;
+    t1.tcnt = TCNT1;
+    t1.top = ICR1;
+    t1.prescaler = t0_prescaler(TCCR1B);
+    if (t1.prescaler == 0)
+      {
+        t1.due = NEVER;
+        return;
+      }
+    t1.base = now - (t_host_time)TCNT1 * t1.prescaler;
+    t1.due = t1.base + ((t_host_time)ICR1 + 1) * t1.prescaler;
+  }
+
+static void do_timer1(void)
+  {
+    if (TIMSK & (1<<TOIE1)) pending |= (1<<HOST_VEC_TIMER1_OVF);
+    t1.base = now;
+    t1.due += ((t_host_time)t1.top + 1) * t1.prescaler;
+    TCNT1 = t1.tcnt = 0;
+  }
+
+static void sync_all(void)
+  {
+    sync_timer0();
+    sync_timer1();
+  }
+
+//------------------------------------------------------------------------
+// interrupt dispatcher
+
+static void dispatch(void)
+  {
+    unsigned char i, vec;
+
+    restart:
+    for (i=0; i<HOST_VEC_MAX; i++)
+      {
+        if (!(SREG & (1<<SREG_I))) return;
+        vec = vector_order[i];
+        if (pending & (1<<vec))
+          {
+            pending &= ~(1<<vec);
+            isr_count[vec]++;
+            if (vectors[vec])
+              {
+                t_host_time entry = now;
+                SREG &= ~(1<<SREG_I);
+                vectors[vec]();
+                SREG |= (1<<SREG_I);                // reti
+                isr_cycles[vec] += now - entry;     // busy waits only
+              }
+            sync_all();
+            goto restart;
+          }
+      }
+  }
+
+void host_sei(void)
+  {
+    SREG |= (1<<SREG_I);
+    sync_all();
+    dispatch();
+  }
+
+//------------------------------------------------------------------------
+// the clock
+
+static t_host_time next_event(void)
+  {
+    t_host_time next = stimulus_due;
+
+    if (t0.due < next) next = t0.due;
+    if (t0.cmp_due < next) next = t0.cmp_due;
+    if (t1.due < next) next = t1.due;
+    if ((eeprom_ready > now) && (eeprom_ready < next)) next = eeprom_ready;
+    return(next);
+  }
+
+static void watch_ack(void)
+  {
+    unsigned char on = (PORTD & (1<<PD7)) != 0;
+
+    if (on == ack_on) return;
+    ack_on = on;
+    if (on)
+      {
+        ack_start = now;
+        ack_count++;
+      }
+    else
+      {
+        ack_length = now - ack_start;
+      }
+  }
+
+static void watch_outputs(void)
+  {
+    unsigned char i;
+    unsigned char end = (now - out_window >= DUTY_WINDOW);
+
+    if ((PORTB != out_state) || end)
+      {
+        for (i=0; i<8; i++)
+          {
+            if (out_state & (1<<i)) out_on[i] += now - out_since;
+          }
+        out_state = PORTB;
+        out_since = now;
+      }
+    if (end)
+      {
+        memcpy(out_duty, out_on, sizeof(out_duty));
+        memset(out_on, 0, sizeof(out_on));
+        out_duty_len = now - out_window;
+        out_window = now;
+      }
+  }
+
+// process all events up to (and including) time 'until'
+static void advance_to(t_host_time until)
+  {
+    t_host_time next;
+
+    sync_all();
+    watch_ack();
+    watch_outputs();
+    while ((next = next_event()) <= until)
+      {
+        now = next;
+        sync_all();                             // TCNTx up to date for the ISR
+        if (stimulus_due == now) do_stimulus();
+        if (t1.due == now) do_timer1();
+        if (t0.due == now) do_timer0();
+        if (t0.cmp_due == now) do_timer0_cmp();
+        dispatch();
+        sync_all();
+        watch_ack();
+        watch_outputs();
+      }
+    now = until;
+    sync_all();
+  }
+
+unsigned char host_poll(void)
+  {
+    t_host_time next;
+
+    next = next_event();
+    if ((stimulus_due == NEVER) && (now < end_time) && (next > end_time)) next = end_time;
+    if (next != NEVER) advance_to(next);
+
+    if ((stimulus_due == NEVER) && (now >= end_time)) return(FALSE);
+    return(TRUE);
+  }
+
+void host_advance(t_host_time until)
+  {
+    if (until > now) advance_to(until);
+  }
+
+void host_burn(uint32_t cycles)
+  {
+    advance_to(now + cycles);
+  }
+
+//------------------------------------------------------------------------
+// eeprom
+//
+// all EEMEM variables are placed in the section host_eeprom,
+// the linker provides start and end of it.
+
+extern uint8_t __start_host_eeprom[];
+extern uint8_t __stop_host_eeprom[];
+
+static void eeprom_check(const uint8_t *p)
+  {
+    if ((p < __start_host_eeprom) || (p >= __stop_host_eeprom))
+      {
+        fprintf(stderr, "host: eeprom access outside EEMEM at %p\n", (const void *)p);
+        abort();
+      }
+  }
+
+uint8_t eeprom_is_ready(void)
+  {
+    if (now >= eeprom_ready) return(TRUE);
+    host_poll();                                // let time run
+    return(FALSE);
+  }
+
+uint8_t eeprom_read_byte(const uint8_t *p)
+  {
+    eeprom_check(p);
+    if (now < eeprom_ready) advance_to(eeprom_ready);
+    return(*p);
+  }
+
+void eeprom_write_byte(uint8_t *p, uint8_t value)
+  {
+    eeprom_check(p);
+    if (now < eeprom_ready) advance_to(eeprom_ready);
+    *p = value;
+    eeprom_writes++;
+    eeprom_ready = now + EEPROM_WRITE_TIME;
+  }
+
+//------------------------------------------------------------------------
+// uart: one byte in the shift register, one in UDR
+
+void host_uart_tx(uint8_t data)
+  {
+    t_host_time start;
+
+    if (uart_free > now + UART_BYTE_TIME)
+      {
+        advance_to(uart_free - UART_BYTE_TIME);  // wait for UDRE
+      }
+    start = (uart_free > now) ? uart_free : now;
+    uart_free = start + UART_BYTE_TIME;
+    if (uart_count < UART_LOG_SIZE)
+      {
+        uart_log[uart_count].start = start;
+        uart_log[uart_count].since_edge = start - last_edge;
+        uart_log[uart_count].data = data;
+        uart_count++;
+      }
+  }
+
+unsigned int host_uart_count(void)
+  {
+    return(uart_count);
+  }
+
+const t_host_uart *host_uart_log(unsigned int index)
+  {
+    return(&uart_log[index]);
+  }
+
+//------------------------------------------------------------------------
+// message trace
+
+int host_trace_open(FILE *f)
+  {
+    trace_out = f;
+    trace_last = 0;
+    return(dcc_trace_write_header(f));
+  }
+
+void host_trace_message(const volatile unsigned char *dcc, unsigned char size)
+  {
+    t_dcc_trace_rec rec;
+    unsigned char i;
+
+    if (!trace_out) return;
+    rec.time_us = now / (F_CPU / 1000000L);
+    rec.size = (size > DCC_TRACE_MAX_SIZE) ? DCC_TRACE_MAX_SIZE : size;
+    for (i=0; i<rec.size; i++) rec.dcc[i] = dcc[i];
+    dcc_trace_write(trace_out, &trace_last, &rec);
+  }
+
+//------------------------------------------------------------------------
+// reset and run
+
+static void host_reset(void)
+  {
+    SREG = 0;
+    PORTA = PORTB = PORTC = PORTD = PORTE = 0;
+    DDRA = DDRB = DDRC = DDRD = DDRE = 0;
+    PINA = PINB = PINC = PINE = 0xFF;           // pull ups
+    PIND = (PIND & (1<<PD2)) | ~(1<<PD2);       // keep DCCIN level
+    MCUCR = EMCUCR = GICR = GIFR = 0;
+    TIMSK = TIFR = ETIMSK = ETIFR = 0;
+    TCCR0 = TCNT0 = OCR0 = 0;
+    TCCR1A = TCCR1B = 0;
+    TCNT1 = OCR1A = OCR1B = ICR1 = 0;
+    TCCR2 = TCNT2 = OCR2 = 0;
+    TCCR3A = TCCR3B = 0;
+    TCNT3 = OCR3A = OCR3B = ICR3 = 0;
+    memset(&t0, 0, sizeof(t0));
+    memset(&t1, 0, sizeof(t1));
+    t0.due = t1.due = NEVER;
+    t0.cmp_due = t1.cmp_due = NEVER;
+    pending = 0;
+  }
+
+void host_restart(void)
+  {
+    restarts++;
+    longjmp(restart_point, 1);
+  }
+
+int host_run(int (*entry)(void))
+  {
+    if (setjmp(restart_point) == 0)
+      {
+        now = 0;
+        PIND = (uint8_t)~(1<<PD2);              // dcc starts low
+        stimulus_pos = 0;
+        stimulus_due = stimulus_len ? start : NEVER;
+        end_time = start + runout;
+      }
+    host_reset();
+    return(entry());
+  }
+
+//------------------------------------------------------------------------
+// statistics
+
+t_host_time host_now(void)
+  {
+    return(now);
+  }
+
+unsigned long host_isr_count(unsigned char vector)
+  {
+    return(isr_count[vector]);
+  }
+
+t_host_time host_isr_cycles(unsigned char vector)
+  {
+    return(isr_cycles[vector]);
+  }
+
+unsigned long host_eeprom_writes(void)
+  {
+    return(eeprom_writes);
+  }
+
+unsigned char host_restarts(void)
+  {
+    return(restarts);
+  }
+
+unsigned long host_ack_count(void)
+  {
+    return(ack_count);
+  }
+
+t_host_time host_ack_length(void)
+  {
+    return(ack_length);
+  }
+
+double host_output_duty(unsigned char bit)
+  {
+    if ((bit > 7) || (out_duty_len == 0)) return(0);
+    return((double)out_duty[bit] / out_duty_len);
+  }
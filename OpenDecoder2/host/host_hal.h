@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host_hal.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2
+//            simulated hardware (registers, timer0, timer1, INT0,
+//            EEPROM) with a cycle counted clock.
+//
+//------------------------------------------------------------------------
+#ifndef _HOST_HAL_H_
+#define _HOST_HAL_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+// simulated time is counted in cpu cycles (F_CPU)
+typedef unsigned long long t_host_time;
+
+#define HOST_US(us)     ((t_host_time)(us) * (F_CPU / 1000000L))
+#define HOST_MS(ms)     ((t_host_time)(ms) * (F_CPU / 1000L))
+
+
+// stimulus: a dcc signal is a sequence of half bits; each half bit
+// toggles DCCIN, the first one starts with a rising edge.
+void host_dcc_halfbit(uint16_t duration_us);
+unsigned int host_stimulus_length(void);
+
+void host_set_start(t_host_time delay);   // begin of stimulus
+void host_set_runout(t_host_time extra);  // run time after last halfbit
+
+// main loop interface (see HOST_WAIT() in config.h)
+unsigned char host_poll(void);           // advance to next event,
+                                         // FALSE if end of run reached
+void host_burn(uint32_t cycles);         // busy wait
+void host_advance(t_host_time until);    // run ISRs up to this time (replay)
+void host_sei(void);
+void host_restart(void) __attribute__((noreturn));
+
+// run the decoder: calls entry, restarts it on host_restart()
+int host_run(int (*entry)(void));
+
+// statistics
+t_host_time host_now(void);
+unsigned long host_isr_count(unsigned char vector);
+t_host_time host_isr_cycles(unsigned char vector);  // busy waiting in the ISR
+unsigned long host_eeprom_writes(void);
+unsigned char host_restarts(void);
+unsigned long host_ack_count(void);      // pulses on DCC_ACK (PD7)
+t_host_time host_ack_length(void);       // of the last pulse
+double host_output_duty(unsigned char bit);  // PORTB, 0..1 in the last 100ms
+
+// uart0 transmitter (railcom): every byte is logged
+typedef struct
+  {
+    t_host_time start;                  // start bit
+    t_host_time since_edge;             // start - last dcc edge
+    uint8_t data;
+  } t_host_uart;
+
+void host_uart_tx(uint8_t data);        // waits like UDRE
+unsigned int host_uart_count(void);
+const t_host_uart *host_uart_log(unsigned int index);
+
+// trace of the messages at the end bit, called by the receiver (dcc_trace.h)
+int host_trace_open(FILE *f);            // writes the header
+void host_trace_message(const volatile unsigned char *dcc, unsigned char size);
+
+#define HOST_VEC_INT0       0
+#define HOST_VEC_TIMER0_OVF 1
+#define HOST_VEC_TIMER0_COMP 2
+#define HOST_VEC_TIMER1_OVF 3
+#define HOST_VEC_MAX        4
+
+#endif // _HOST_HAL_H_
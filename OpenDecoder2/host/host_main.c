@@ -0,0 +1,276 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host_main.c
+// history:   2026-10-17 V0.1 start
+//            2026-10-17          packets are sent with dcc_gen.c
+//            2026-10-17          -w: trace of the received messages
+//            2026-10-17          prefilter statistics
+//            2026-10-17          duty cycle of the outputs
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2 - runner
+//
+// usage:     OpenDecoder2_host [-r repeat] [-s ms] [-t ms] [-o edgefile]
+//                               [-c] [-u uartfile] [-p bits] [-j us] [-z us]
+//                               [-g rate[:us]] [-w tracefile]
+//                               [packetfile] [-e edgefile]
+//
+//            packetfile: one dcc packet per line, bytes in hex, without
+//            XOR (is appended here); '#' starts a comment.
+//            -e: recorded edges, one timestamp in us per line (e.g. from
+//                a logic analyzer); the first line is the first edge.
+//            -o: write the edges of the complete stimulus in this format
+//                (give it before the packet and edge files)
+//            -r: each packet is sent 'repeat' times (default 1)
+//            -s: start of the dcc signal in ms (default 2500, this is
+//                after servo power up and init of the decoder)
+//            -t: run time after the last packet in ms (default 100)
+//            -c: railcom cutout after each packet (give it before the
+//                packet file)
+//            -u: write the uart (railcom) bytes: time in us, time since
+//                the last dcc edge in us, data
+//            -p: preamble bits (default 14)
+//            -j: jitter of each half bit, +/- us
+//            -z: zero stretching, us added to the first half of a '0'
+//            -g: glitch in average every 'rate' half bits, pulse of
+//                'us' (default 2)
+//            -c, -p, -j, -z and -g apply to the following packet files.
+//            -w: write all messages seen by the receiver (before the
+//                prefilter) to a binary trace (dcc_trace.h), input of
+//                OpenDecoder2_replay
+//            without packetfile only idle packets are sent.
+//
+//------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "host_hal.h"
+#include "dcc_gen.h"
+#include "../config.h"
+#include "../dcc_receiver.h"
+#include "../dcc_decode.h"
+
+int decoder_main(void);
+
+static FILE *edge_out;
+static unsigned long edge_time;
+static t_dcc_gen gen;
+
+static void add_halfbit(uint16_t t)
+  {
+    host_dcc_halfbit(t);
+    if (edge_out) fprintf(edge_out, "%lu\n", edge_time);
+    edge_time += t;
+  }
+
+static unsigned int read_packets(FILE *f, unsigned int repeat)
+  {
+    char line[256];
+    unsigned char data[8];
+    unsigned int count = 0;
+
+    while (fgets(line, sizeof(line), f))
+      {
+        char *p = line, *end;
+        unsigned char size = 0;
+        unsigned int i;
+
+        if (strchr(p, '#')) *strchr(p, '#') = 0;
+        while (size < sizeof(data))
+          {
+            unsigned long v = strtoul(p, &end, 16);
+            if (end == p) break;
+            data[size++] = v;
+            p = end;
+          }
+        if (size == 0) continue;
+        for (i=0; i<repeat; i++) dcc_gen_packet(&gen, data, size);
+        count += repeat;
+      }
+    return(count);
+  }
+
+// recorded edges: absolute timestamps in us
+
+static unsigned int read_edges(FILE *f)
+  {
+    char line[256];
+    unsigned long t, last = 0;
+    unsigned int count = 0;
+
+    while (fgets(line, sizeof(line), f))
+      {
+        char *end;
+
+        if (strchr(line, '#')) *strchr(line, '#') = 0;
+        t = strtoul(line, &end, 10);
+        if (end == line) continue;
+        if (count++ && (t > last)) add_halfbit((t - last > 0xFFFF) ? 0xFFFF : t - last);
+        last = t;
+      }
+    return(count);
+  }
+
+//------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+  {
+    unsigned int repeat = 1;
+    unsigned long start = 2500;
+    unsigned long runout = 100;
+    unsigned int packets = 0;
+    unsigned int edges = 0;
+    FILE *uart_out = NULL;
+    FILE *trace_out = NULL;
+    int i;
+
+    dcc_gen_init(&gen, add_halfbit);
+
+    for (i=1; i<argc; i++)
+      {
+        if (!strcmp(argv[i], "-r") && (i+1 < argc)) repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc)) start = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && (i+1 < argc)) runout = atol(argv[++i]);
+        else if (!strcmp(argv[i], "-c")) gen.cutout = 1;
+        else if (!strcmp(argv[i], "-p") && (i+1 < argc)) gen.preamble = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-j") && (i+1 < argc)) gen.jitter = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-z") && (i+1 < argc)) gen.stretch = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-g") && (i+1 < argc))
+          {
+            char *end;
+            gen.glitch_rate = strtoul(argv[++i], &end, 10);
+            if (*end == ':') gen.glitch_len = atoi(end + 1);
+          }
+        else if (!strcmp(argv[i], "-u") && (i+1 < argc))
+          {
+            uart_out = fopen(argv[++i], "w");
+            if (!uart_out)
+              {
+                perror(argv[i]);
+                return(1);
+              }
+          }
+        else if (!strcmp(argv[i], "-w") && (i+1 < argc))
+          {
+            trace_out = fopen(argv[++i], "wb");
+            if (!trace_out || host_trace_open(trace_out))
+              {
+                perror(argv[i]);
+                return(1);
+              }
+          }
+        else if (!strcmp(argv[i], "-o") && (i+1 < argc))
+          {
+            edge_out = fopen(argv[++i], "w");
+            if (!edge_out)
+              {
+                perror(argv[i]);
+                return(1);
+              }
+          }
+        else if (!strcmp(argv[i], "-e") && (i+1 < argc))
+          {
+            FILE *f = fopen(argv[++i], "r");
+            if (!f)
+              {
+                perror(argv[i]);
+                return(1);
+              }
+            edges += read_edges(f);
+            fclose(f);
+          }
+        else
+          {
+            FILE *f = fopen(argv[i], "r");
+            if (!f)
+              {
+                perror(argv[i]);
+                return(1);
+              }
+            packets += read_packets(f, repeat);
+            fclose(f);
+          }
+      }
+    if ((packets == 0) && (edges == 0))
+      {
+        unsigned char idle[2] = { 0xFF, 0x00 };
+        for (i=0; i<repeat; i++) dcc_gen_packet(&gen, idle, 2);
+        packets = repeat;
+      }
+
+    if (edge_out)
+      {
+        fprintf(edge_out, "%lu\n", edge_time);     // last edge
+        fclose(edge_out);
+      }
+
+    host_set_start(HOST_MS(start));
+    host_set_runout(HOST_MS(runout));
+    host_run(decoder_main);
+
+    printf("simulated:    %.3f ms\n", host_now() * 1000.0 / F_CPU);
+    printf("packets:      %u, edges: %u (%u half bits)\n", packets, edges, host_stimulus_length());
+    printf("generator:    %lu bits, %lu glitches\n", gen.bits, gen.glitches);
+    printf("isr:          INT0 %lu, TIMER0_OVF %lu, TIMER0_COMP %lu, TIMER1_OVF %lu\n",
+           host_isr_count(HOST_VEC_INT0), host_isr_count(HOST_VEC_TIMER0_OVF),
+           host_isr_count(HOST_VEC_TIMER0_COMP), host_isr_count(HOST_VEC_TIMER1_OVF));
+    printf("isr time:     INT0 %.0f us, TIMER0_OVF %.0f us, TIMER0_COMP %.0f us, TIMER1_OVF %.0f us\n",
+           host_isr_cycles(HOST_VEC_INT0) * 1e6 / F_CPU, host_isr_cycles(HOST_VEC_TIMER0_OVF) * 1e6 / F_CPU,
+           host_isr_cycles(HOST_VEC_TIMER0_COMP) * 1e6 / F_CPU, host_isr_cycles(HOST_VEC_TIMER1_OVF) * 1e6 / F_CPU);
+    printf("restarts:     %u\n", host_restarts());
+    printf("ack:          %lu pulses, last %.1f ms\n", host_ack_count(), host_ack_length() * 1000.0 / F_CPU);
+    printf("eeprom:       %lu writes\n", host_eeprom_writes());
+    printf("dcc queue:    max. %u, %u lost\n", dcc_queue.max_level, dcc_queue.overflow);
+    #if (DCC_HEALTH == TRUE)
+    printf("health:       %u accepted, %u xor, %u overrun, %u oversize, %u preamble, %u spike\n",
+           dcc_health.accepted, dcc_health.xor_error, dcc_health.overrun,
+           dcc_health.oversize, dcc_health.preamble_abort, dcc_health.spike);
+    #endif
+    #if (DCC_PREFILTER == TRUE)
+    printf("prefilter:    %u dropped (not for us)\n", dcc_filter.dropped);
+    #endif
+    #if (DCC_DEDUP == TRUE)
+    printf("dedup:        %u repeats dropped, %u commands\n", dedup_stat.hits, dedup_stat.misses);
+    #endif
+    #if (ALTERNATE_RECEIVE == 2)
+    printf("bits:         %u, half '1' %u..%u, half '0' %u..%u, %u bad, %u asym\n",
+           dcc_bitstat.bits, dcc_bitstat.one_min, dcc_bitstat.one_max,
+           dcc_bitstat.zero_min, dcc_bitstat.zero_max, dcc_bitstat.bad_half, dcc_bitstat.asym);
+    #endif
+    printf("uart:         %u bytes\n", host_uart_count());
+    printf("PORTB:        0x%02X\n", PORTB);
+    printf("PORTB duty:  ");
+    for (i=0; i<8; i++) printf(" %5.1f", host_output_duty(i) * 100);
+    printf(" %% (PB0..PB7, last 100 ms)\n");
+    printf("PORTD:        0x%02X\n", PORTD);
+    printf("OCR1A/B:      %u / %u\n", OCR1A, OCR1B);
+
+    if (trace_out) fclose(trace_out);
+
+    if (uart_out)
+      {
+        for (i=0; i<host_uart_count(); i++)
+          {
+            const t_host_uart *u = host_uart_log(i);
+            fprintf(uart_out, "%.1f %.1f %02X\n", u->start * 1e6 / F_CPU,
+                    u->since_edge * 1e6 / F_CPU, u->data);
+          }
+        fclose(uart_out);
+      }
+    return(0);
+  }
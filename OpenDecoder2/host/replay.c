@@ -0,0 +1,265 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      replay.c
+// history:   2026-10-17 V0.1 start
+//            2026-10-17          DCC_PREFILTER: receiver check before decode
+//
+//------------------------------------------------------------------------
+//
+// purpose:   host build of OpenDecoder2 - replay benchmark
+//
+// usage:     OpenDecoder2_replay [-n loops] [-s ms] tracefile
+//
+//            The decoder is started as usual (main, until 's' ms of
+//            simulated time, default 2500); then all messages of the
+//            trace (dcc_trace.h, e.g. from OpenDecoder2_host -w) are
+//            given to analyze_message() and dispatch_message(), 'loops'
+//            times (default 100).
+//
+//            Between two messages the simulated time is advanced to the
+//            time of the trace (timer ISRs run, repeats age out of the
+//            dedup); only the calls themselves are measured with the
+//            wall clock of the host, the cost of reading the clock is
+//            subtracted.
+//
+//            With DCC_PREFILTER the XOR and the prefilter of the
+//            receiver are applied first (and measured); dropped packets
+//            do not reach analyze_message().
+//
+//            Reported:
+//              - packets/s of decode and dispatch, compared with the
+//                packet rate of the trace
+//              - result of analyze_message(): accepted (2, 3, 4),
+//                rejected (1, not our address), consumed (0); dropped
+//                by the receiver
+//              - time per packet of analyze_message() and of the
+//                handler (dispatch_message(), by CV33 mode), by result
+//
+//------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "host_hal.h"
+#include "dcc_trace.h"
+#include "../config.h"
+#include "../dcc_receiver.h"
+#include "../dcc_decode.h"
+#include "../main.h"
+
+int decoder_main(void);
+
+#define DROPPED     5                   // analyze_message() returns 0..4
+#define RESULTS     6
+
+static t_message *trace;
+static uint64_t *trace_time;            // us, from the first message
+static unsigned int trace_len;
+static uint64_t trace_us;               // duration of the trace
+static unsigned int loops = 100;
+
+typedef struct
+  {
+    unsigned long count;
+    double analyze_ns;
+    double dispatch_ns;
+  } t_class;
+
+static t_class result[RESULTS];
+static double run_s;
+static double clock_ns;                 // cost of one clock read
+
+static const char *result_name[RESULTS] =
+  {
+    "consumed",                         // service mode, PoM, repeat, ...
+    "not for us",
+    "my address",
+    "in window",
+    "loco",
+    "dropped",                          // receiver: XOR, prefilter
+  };
+
+static double now_ns(void)
+  {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return(ts.tv_sec * 1e9 + ts.tv_nsec);
+  }
+
+static int load_trace(const char *name)
+  {
+    FILE *f;
+    t_dcc_trace_rec rec;
+    uint64_t last = 0, first = 0;
+    unsigned int size = 0;
+    int ret;
+
+    f = fopen(name, "rb");
+    if (!f)
+      {
+        perror(name);
+        return(-1);
+      }
+    if (dcc_trace_read_header(f))
+      {
+        fprintf(stderr, "%s: not a dcc trace\n", name);
+        fclose(f);
+        return(-1);
+      }
+    while ((ret = dcc_trace_read(f, &last, &rec)) == 0)
+      {
+        if (trace_len == size)
+          {
+            size = size ? 2 * size : 4096;
+            trace = realloc(trace, size * sizeof(trace[0]));
+            trace_time = realloc(trace_time, size * sizeof(trace_time[0]));
+            if (!trace || !trace_time)
+              {
+                perror("load_trace");
+                exit(1);
+              }
+          }
+        if (trace_len == 0) first = rec.time_us;
+        memset(&trace[trace_len], 0, sizeof(trace[0]));
+        trace[trace_len].size = rec.size;
+        memcpy(trace[trace_len].dcc, rec.dcc, rec.size);
+        trace_time[trace_len] = rec.time_us - first;
+        trace_len++;
+      }
+    fclose(f);
+    if (ret != -1) fprintf(stderr, "%s: truncated after %u records\n", name, trace_len);
+    trace_us = last - first;
+    return(0);
+  }
+
+#if (DCC_PREFILTER == TRUE)
+// what the receiver ISR does at the end bit
+static unsigned char receiver_check(t_message *msg)
+  {
+    unsigned char i, myxor = 0;
+
+    for (i=0; i<msg->size; i++) myxor ^= msg->dcc[i];
+    if (myxor) return(FALSE);
+    return(dcc_prefilter(msg->dcc));
+  }
+#endif
+
+// runs after the decoder has started, within host_run()
+static int replay(void)
+  {
+    unsigned int l, i;
+    unsigned char ret;
+    double t0, t1, t2;
+    t_host_time base;
+
+    if (host_restarts())
+      {
+        fprintf(stderr, "decoder reset during replay (e.g. CV8 write), stopped\n");
+        return(1);
+      }
+    decoder_main();                     // init, returns at end of start time
+
+    t0 = now_ns();
+    for (i=0; i<1000; i++) now_ns();
+    clock_ns = (now_ns() - t0) / 1001;
+
+    for (l=0; l<loops; l++)
+      {
+        base = host_now() + HOST_MS(10);    // gap between two loops
+        for (i=0; i<trace_len; i++)
+          {
+            host_advance(base + HOST_US(trace_time[i]));
+            t0 = now_ns();
+            #if (DCC_PREFILTER == TRUE)
+            if (!receiver_check(&trace[i]))
+              {
+                t1 = now_ns();
+                result[DROPPED].count++;
+                result[DROPPED].analyze_ns += t1 - t0 - clock_ns;
+                run_s += (t1 - t0 - clock_ns) / 1e9;
+                continue;
+              }
+            #endif
+            ret = analyze_message(&trace[i]);
+            t1 = now_ns();
+            dispatch_message(ret);
+            t2 = now_ns();
+            if (ret >= DROPPED) ret = 0;
+            result[ret].count++;
+            result[ret].analyze_ns += t1 - t0 - clock_ns;
+            result[ret].dispatch_ns += t2 - t1 - clock_ns;
+            run_s += (t2 - t0 - 2 * clock_ns) / 1e9;
+          }
+      }
+    return(0);
+  }
+
+int main(int argc, char **argv)
+  {
+    unsigned long start = 2500;
+    unsigned long total, accepted;
+    const char *name = NULL;
+    int i;
+
+    for (i=1; i<argc; i++)
+      {
+        if (!strcmp(argv[i], "-n") && (i+1 < argc)) loops = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && (i+1 < argc)) start = atol(argv[++i]);
+        else name = argv[i];
+      }
+    if (!name || (loops == 0))
+      {
+        fprintf(stderr, "usage: %s [-n loops] [-s ms] tracefile\n", argv[0]);
+        return(2);
+      }
+    if (load_trace(name)) return(1);
+    if (trace_len == 0)
+      {
+        fprintf(stderr, "%s: no messages\n", name);
+        return(1);
+      }
+
+    host_set_start(0);
+    host_set_runout(HOST_MS(start));
+    if (host_run(replay)) return(1);
+
+    total = (unsigned long)trace_len * loops;
+    accepted = result[2].count + result[3].count + result[4].count;
+
+    printf("trace:        %u messages, %.3f s", trace_len, trace_us / 1e6);
+    if (trace_us) printf(", %.0f packets/s", trace_len * 1e6 / trace_us);
+    printf("\n");
+    printf("mode:         %u\n", my_mode);
+    printf("replayed:     %lu messages, %.3f s in decode and dispatch\n", total, run_s);
+    printf("throughput:   %.0f packets/s, %.1f ns/packet", total / run_s, run_s * 1e9 / total);
+    if (trace_us) printf(", %.0fx real time", (total / run_s) / (trace_len * 1e6 / trace_us));
+    printf("\n");
+    printf("accepted:     %lu (%.1f%%), rejected %lu (%.1f%%), consumed %lu (%.1f%%), dropped %lu (%.1f%%)\n",
+           accepted, 100.0 * accepted / total,
+           result[1].count, 100.0 * result[1].count / total,
+           result[0].count, 100.0 * result[0].count / total,
+           result[DROPPED].count, 100.0 * result[DROPPED].count / total);
+    printf("per packet:   %-12s %10s %12s %12s\n", "result", "count", "analyze ns", "handler ns");
+    for (i=0; i<RESULTS; i++)
+      {
+        if (result[i].count == 0) continue;
+        printf("              %-12s %10lu %12.1f %12.1f\n", result_name[i], result[i].count,
+               result[i].analyze_ns / result[i].count, result[i].dispatch_ns / result[i].count);
+      }
+    return(0);
+  }
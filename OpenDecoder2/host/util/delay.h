@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+// 
+//------------------------------------------------------------------------
+//
+// file:      host/util/delay.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   stand-in for <util/delay.h> on the host build
+//            busy waiting advances the simulated clock by the cycles
+//            the AVR loop would take; interrupts run meanwhile.
+//
+//------------------------------------------------------------------------
+#ifndef _UTIL_DELAY_H_
+#define _UTIL_DELAY_H_
+
+#include <stdint.h>
+
+void host_burn(uint32_t cycles);
+
+static inline void _delay_loop_1(uint8_t __count)
+  {
+    host_burn(3L * (__count ? __count : 256));
+  }
+
+static inline void _delay_loop_2(uint16_t __count)
+  {
+    host_burn(4L * (__count ? __count : 65536L));
+  }
+
+#define _delay_us(us)   host_burn((uint32_t)((F_CPU / 1e6) * (us)))
+#define _delay_ms(ms)   host_burn((uint32_t)((F_CPU / 1e3) * (ms)))
+
+#endif // _UTIL_DELAY_H_
@@ -38,6 +38,17 @@
 //            2011-12-13          added manual control for Servos
 //            2011-12-25 V0.14 kw added RGB, modes 33 and 34
 //            2012-12-26 V0.15 kw added direct mode 3
+//            2026-10-17          main loop runs on host build (see host/)
+//            2026-10-17          messages are taken from dcc_queue
+//            2026-10-17          CV are written back in the background
+//            2026-10-17          added RailCom (railcom.c)
+//            2026-10-17          added function decoder, mode 48 (fn_decoder.c)
+//            2026-10-17          SIMULATION 2 generator moved to host/dcc_gen.c
+//            2026-10-17          dispatch of messages in dispatch_message()
+//            2026-10-17          receiver prefilter open while learning the
+//                               address; dedup aged in the main loop
+//            2026-10-17          added dimmer, mode 4 (dimmer.c)
+//            2026-10-17          added light sequences, mode 6 (sequence.c)
 //
 //
 //------------------------------------------------------------------------
@@ -79,13 +90,16 @@
 #include "servo.h"               // servo
 #include "keyboard.h"
 #include "rgb.h"                 // RGB-LED
+#include "railcom.h"             // RailCom transmitter
+#include "fn_decoder.h"          // function decoder
+#include "dimmer.h"              // soft pwm dimmer
+#include "sequence.h"            // light sequences
 
 #include "main.h"
 
 #define SIMULATION  0               // 0: real application
                                     // 0: test receive (with stimuli)
-                                    // 2: test receive and decode routine - please enable SIMULATION
-                                    //                           also in dcc_receiver
+                                    // 2: test receive and decode routine - see host/dcc_gen.c
                                     // 3: test timing engine
                                     // 4: test action
 
@@ -464,11 +478,13 @@ void DoProgramming(void)
     unsigned char myCommand;
     signed char my_timerval;
     unsigned char pulsdelay;
+    unsigned char retval;
+    t_message *dcc_msg;
     
        
 
     my_timerval = timerval;
-    while(timerval - my_timerval < DEBOUNCE) ;          // wait
+    while(timerval - my_timerval < DEBOUNCE) HOST_WAIT();          // wait
 
     if (PROG_PRESSED)                                   // still pressed?
       {
@@ -477,18 +493,23 @@ void DoProgramming(void)
         while(PROG_PRESSED) ;                           // wait for release
 
         my_timerval = timerval;
-        while(timerval - my_timerval < DEBOUNCE) ;     // wait
+        while(timerval - my_timerval < DEBOUNCE) HOST_WAIT();     // wait
         
+        #if (DCC_PREFILTER == TRUE)
+            dcc_filter.open |= (1 << FILTER_PROG);      // any accessory address
+        #endif
         while(!PROG_PRESSED)
           {
-            if (semaphor_get(C_Received))
+            if ((dcc_msg = get_dcc_message()) != 0)
               {                                         // Message
-                if (analyze_message(&incoming))                  // yes, any accessory
+                retval = analyze_message(dcc_msg);
+                release_dcc_message();
+                if (retval && (received.type & RX_ACC))         // yes, any accessory
                   {
-                    my_eeprom_write_byte(&CV.myAddrL, (unsigned char) ReceivedAddr & 0b00111111  );     
-                    my_eeprom_write_byte(&CV.myAddrH, (unsigned char) (ReceivedAddr >> 6) & 0b00000111);
+                    my_eeprom_write_byte(&CV.myAddrL, (unsigned char) received.addr & 0b00111111  );     
+                    my_eeprom_write_byte(&CV.myAddrH, (unsigned char) (received.addr >> 6) & 0b00000111);
                     
-                    myCommand = ReceivedCommand & 0x07;
+                    myCommand = received.command & 0x07;
                     
                     if (myCommand == 0)      pulsdelay =  200000L / TICK_PERIOD; 
                     else if (myCommand == 1) pulsdelay =  500000L / TICK_PERIOD; 
@@ -525,34 +546,25 @@ void DoProgramming(void)
                           }
                       }
                     
-                    do {} while (!eeprom_is_ready());    // wait for write to complete
+                    my_eeprom_flush();                  // wait for write to complete
                     
                     LED_OFF;
 
                     // we got reprogrammed ->
                     // forget everthing running and restart decoder!                    
                     
-                    cli();
-                    
-                    // laut diversen Internetseiten sollte folgender Code laufen -
-                    // tuts aber nicht, wenn man das Assemblerlistung ansieht.
-                    // void (*funcptr)( void ) = 0x0000;    // Set up function pointer
-                    // funcptr();                        // Jump to Reset vector 0x0000
-                    
-                    __asm__ __volatile 
-                    (
-                       "ldi r30,0"  "\n\t"
-                       "ldi r31,0"  "\n\t"
-                       "icall" "\n\t"
-                     );
+                    _restart();                         // see config.h
                     
                     // return;  
                   }
               }
           }  // while
+        #if (DCC_PREFILTER == TRUE)
+            dcc_filter.open &= ~(1 << FILTER_PROG);
+        #endif
         turn_led_off();
         my_timerval = timerval;
-        while(timerval - my_timerval < DEBOUNCE) ;     // wait    
+        while(timerval - my_timerval < DEBOUNCE) HOST_WAIT();     // wait    
         while(PROG_PRESSED) ;       // wait for release
       }
     return;   
@@ -568,10 +580,12 @@ void DoProgramming(void)
 
 static void delay_1p9ms(void)
   {
-    if (semaphor_query(C_Received))                     // keep DCC in alive
+    t_message *dcc_msg;
+
+    if ((dcc_msg = get_dcc_message()) != 0)             // keep DCC in alive
           {
-            analyze_message(&incoming);                     // check for service mode
-            semaphor_get(C_Received);                       // now take away the protection
+            analyze_message(dcc_msg);                       // check for service mode
+            release_dcc_message();                          // now free the queue entry
           }
     LED_ON;
     _mydelay_us(90L);
@@ -618,11 +632,115 @@ static void servo_powerup_delay(void)
 #endif // (SERVO_ENABLED == TRUE)
 
 //--------------------------------------------------------------------------------------------
+// perform the result of analyze_message() according to the mode (CV33)
+
+unsigned char my_mode;
+
+void dispatch_message(unsigned char retval)
+  {
+    #if (FUNCTION_ENABLED == TRUE)
+        if ((retval == 4) && (my_mode == FN_MODE))
+          {
+            fn_action();                                // loco functions changed
+          }
+    #endif
+    if ((retval == 2) || (retval == 3))                 // MyAdr or in our window
+      {
+        switch (my_mode)
+          {
+            #if (PORT_ENABLED == TRUE)
+                case 0:
+                    port_action(received.command, received.activate);   // standard accessory decoder
+                    break;
+                case 3:
+                    direct_action(received.command);
+                    break;
+            #endif
+            #if (SERVO_ENABLED == TRUE)
+                case 1:
+                    if (received.activate)
+                      {
+                        servo_action(received.command);  // servo decoder
+                      }
+                    break;
+            #endif
+            #if (SEGMENT_ENABLED == TRUE)
+                case 2:
+                    if (received.activate)
+                      {
+                        servo_action2(received.command);        // multiposition
+                      }
+                    break;
+            #endif
+            #if (REVERSER_ENABLED == TRUE)
+                case 5:
+                    reverser_action(received.command, received.activate);
+                    break;
+            #endif
+            #if (DMX_ENABLED == TRUE)
+                case 8:
+                    if (received.activate)
+                      {
+                        dmx_action(received.command);        // dmx
+                      }
+                    break;
+            #endif
+            #if (NEON_ENABLED == TRUE)
+                case 17:
+                    if (received.activate)
+                      {
+                        neon_action(received.command);
+                      }
+                    break;
+            #endif
+            #if (RGB_ENABLED == TRUE)
+                case 33:
+                    if (received.activate)
+                      {
+                        rgb_direct_action(received.command);
+                      }
+                    break;
+                case 34:
+                    if (received.activate)
+                      {
+                        rgb_action(received.command);        // RGB-Fader + Servo
+                      }
+                    break;
+            #endif
+            #if (FUNCTION_ENABLED == TRUE)
+                case FN_MODE:
+                    break;                          // accessory commands are ignored
+            #endif
+            #if (DIMMER_ENABLED == TRUE)
+                case DIMMER_MODE:
+                    if (received.activate)
+                      {
+                        dimmer_action(received.command);
+                      }
+                    break;
+            #endif
+            #if (SEQUENCE_ENABLED == TRUE)
+                case SEQUENCE_MODE:
+                    if (received.activate)
+                      {
+                        sequence_action(received.command);
+                      }
+                    break;
+            #endif
+            default:
+                flash_led_fast(6);                  		// Error code
+                break;
+          }
+      }
+  }
+
+//--------------------------------------------------------------------------------------------
 
 
 int main(void)
   {
-    unsigned char my_mode;
+    unsigned char retval;
+    t_message *dcc_msg;
     #if (SEGMENT_ENABLED == TRUE)
       unsigned char Pos_Mode;
     #endif
@@ -630,12 +748,18 @@ int main(void)
     // #warning  rgb_action(1);    rgb_simu();
 
 
+    my_eeprom_init();                                   // load CV to RAM
+
     init_main();                                        // setup hardware ports (to do!!)
 
     init_port_engine();                                 // setup timers and states
 
     init_dcc_receiver();                                // setup dcc receiver
 
+    #if (RAILCOM_ENABLED == TRUE)
+        init_railcom();                                 // uart; before init_dcc_decode (railcom_load)
+    #endif
+
     init_dcc_decode();
 
     init_keyboard();                                    // local tracers
@@ -663,6 +787,21 @@ int main(void)
        if (my_mode==1) init_servo();                    // setup servos and recovers old position
     #endif
 
+    #if (FUNCTION_ENABLED == TRUE)
+       #if (SERVO_ENABLED == TRUE)
+       if (my_mode==FN_MODE) init_servo();              // servos may be mapped to functions
+       #endif
+       if (my_mode==FN_MODE) init_fn_decoder();
+    #endif
+
+    #if (DIMMER_ENABLED == TRUE)
+       if (my_mode==DIMMER_MODE) init_dimmer();         // timer0 pwm, fades in the last state
+    #endif
+
+    #if (SEQUENCE_ENABLED == TRUE)
+       if (my_mode==SEQUENCE_MODE) init_sequence();     // load code, restart the last sequences
+    #endif
+
     #if ((SERVO_ENABLED == TRUE) && (RGB_ENABLED == TRUE))
        if (my_mode==34) init_servo();                   // setup servos and recovers old position
     #endif
@@ -693,78 +832,19 @@ int main(void)
 
     while(1)
       {
-        if (semaphor_query(C_Received))
+        #if (HOST_BUILD == TRUE)
+            if (!host_poll()) return(0);                // host: end of stimulus reached
+        #endif
+
+        if ((dcc_msg = get_dcc_message()) != 0)
           {
-            if (analyze_message(&incoming) >= 2)                 // MyAdr or greater received
-              {
-                switch (my_mode)
-                  {
-                    #if (PORT_ENABLED == TRUE)
-                        case 0:
-                            port_action(ReceivedCommand, ReceivedActivate);   // standard accessory decoder
-                            break;
-                        case 3:
-                            direct_action(ReceivedCommand);
-                            break;
-                    #endif
-                    #if (SERVO_ENABLED == TRUE)
-                        case 1:
-                            if (ReceivedActivate)
-                              {
-                                servo_action(ReceivedCommand);  // servo decoder
-                              }
-                            break;
-                    #endif
-                    #if (SEGMENT_ENABLED == TRUE)
-                        case 2:
-                            if (ReceivedActivate)
-                              {
-                                servo_action2(ReceivedCommand);        // multiposition
-                              }
-                            break;
-                    #endif
-                    #if (REVERSER_ENABLED == TRUE)
-                        case 5:
-                            reverser_action(ReceivedCommand, ReceivedActivate);
-                            break;
-                    #endif
-                    #if (DMX_ENABLED == TRUE)
-                        case 8:
-                            if (ReceivedActivate)
-                              {
-                                dmx_action(ReceivedCommand);        // dmx
-                              }
-                            break;
-                    #endif
-                    #if (NEON_ENABLED == TRUE)
-                        case 17:
-                            if (ReceivedActivate)
-                              {
-                                neon_action(ReceivedCommand);
-                              }
-                            break;
-                    #endif
-                    #if (RGB_ENABLED == TRUE)
-                        case 33:
-                            if (ReceivedActivate)
-                              {
-                                rgb_direct_action(ReceivedCommand);
-                              }
-                            break;
-                        case 34:
-                            if (ReceivedActivate)
-                              {
-                                rgb_action(ReceivedCommand);        // RGB-Fader + Servo
-                              }
-                            break;
-                    #endif
-                    default:
-                        flash_led_fast(6);                  		// Error code
-                        break;
-                  }
-              }
-            semaphor_get(C_Received);                       // now take away the protection
+            retval = analyze_message(dcc_msg);
+            dispatch_message(retval);
+            release_dcc_message();                          // now free the queue entry
           }
+        #if (DCC_DEDUP == TRUE)
+            dedup_age();                                    // not every packet reaches analyze_message
+        #endif
 
         if (semaphor_get(C_DoSave) )
           {
@@ -774,6 +854,8 @@ int main(void)
               }
           } 
 
+        my_eeprom_background();                         // write back one CV byte
+
         #if (SIMULATION == 0)
             if (PROG_PRESSED) DoProgramming();
         #endif
@@ -807,6 +889,14 @@ int main(void)
             run_rgb_fader();
         #endif
 
+        #if (DIMMER_ENABLED == TRUE)
+            if (my_mode==DIMMER_MODE) run_dimmer();         // fading, new pwm schedule
+        #endif
+
+        #if (SEQUENCE_ENABLED == TRUE)
+            if (my_mode==SEQUENCE_MODE) run_sequence();     // one tick of the sequences
+        #endif
+
         #if (DMX_ENABLED == TRUE)
             run_dmxkey();                                   // tracers
             run_watchdog();
@@ -825,162 +915,6 @@ int main(void)
 // 1: Test der Empfangrootine; hierzu ein DCC Generator (aus opendcc/dccout.c)
 // 2: Test der Portengine
 //
-#if (SIMULATION == 2)
-
-//                                        Adressbyte   Datenbyte 
-//                                         10AAAAAA    1aaaSCCR    // note: aaa = ~AAA
-unsigned char message_adr001_out0_g[] = {0b10000001, 0b11111001};
-unsigned char message_adr005_out1_g[] = {0b10000101, 0b11111011};
-unsigned char message_adr380_out0_g[] = {0b10111100, 0b10101001};  // 380 = 0x17C = 0b101111100
-
-
-// upstream interface:
-struct
-  {
-    unsigned char size;
-    unsigned char dcc[5];
-  } next_message;
-
-volatile unsigned char next_message_count;
-
-enum do_states
-  {                            // actual state
-     dos_idle,
-     dos_send_preamble,
-     dos_send_bstart,
-     dos_send_byte,
-     dos_send_xor
-  };
-
-struct
-  {
-    enum do_states state;
-
-    unsigned char ibyte;                            // current index of byte in message
-    unsigned char bits_in_state;                    // Bits to output in this state
-    unsigned char cur_byte;                         // current byte
-    unsigned char xor_byte;                              // actual xor
-    unsigned char current_dcc[5];                  // current message in output processing
-    unsigned char bytes_in_message;                 // current size of message (decremented)
-    unsigned char phase;
-  } doi;
-
-
-unsigned char dccbit;
-
-void do_send(unsigned char mydccbit)
-  {
-    dccbit = mydccbit;
-  }
-
-void dcc_bit_generator(void)
-  {
-    switch (doi.state)
-      {
-        case dos_idle:
-            do_send(1);
-            if (next_message_count > 0)
-              {
-                memcpy(doi.current_dcc, next_message.dcc, sizeof(doi.current_dcc));
-                doi.bytes_in_message = next_message.size;
-                // no size checking - if (doi.cur_size > 5) doi.cur_size = 5;
-                next_message_count--;
-                doi.ibyte = 0;
-                doi.xor_byte = 0;
-                doi.bits_in_state = 14;
-                doi.state = dos_send_preamble;
-              }
-            break;
-
-        case dos_send_preamble:
-            do_send(1);
-            doi.bits_in_state--;
-            if (doi.bits_in_state == 0)
-                 doi.state = dos_send_bstart;
-            break;
-
-        case dos_send_bstart:
-            do_send(0);
-            if (doi.bytes_in_message == 0)
-              { // message done, goto xor
-                doi.cur_byte = doi.xor_byte;
-                doi.state = dos_send_xor;
-                doi.bits_in_state = 8;
-              }
-            else
-              { // get next addr or data
-                doi.bytes_in_message--;
-                doi.cur_byte = doi.current_dcc[doi.ibyte++];
-                doi.xor_byte ^= doi.cur_byte;
-                doi.state = dos_send_byte;
-                doi.bits_in_state = 8;
-              }
-            break;
-
-        case dos_send_byte:
-            if (doi.cur_byte & 0x80) do_send(1);
-            else                    do_send(0);
-            doi.cur_byte <<= 1;
-            doi.bits_in_state--;
-            if (doi.bits_in_state == 0)
-              {
-                doi.state = dos_send_bstart;
-              }
-            break;
-
-        case dos_send_xor:
-            if (doi.cur_byte & 0x80) do_send(1);
-            else                    do_send(0);
-            doi.cur_byte <<= 1;
-            doi.bits_in_state--;
-            if (doi.bits_in_state == 0)
-              {
-                doi.state = dos_idle;
-              }
-            break;
-     }
-  }
-
-void dcc_generate_init(void)
-  {
-    doi.state = dos_idle;
-  }
-
-
-void simulat_receive(void)
-  {
-    dcc_generate_init();
-    dcc_bit_generator();
-    dcc_bit_generator();
-    memcpy(next_message.dcc, message_adr001_out0_g, sizeof(doi.current_dcc));
-    next_message.size = 2;
-    next_message_count = 2;
-    while(1)
-      {
-        dcc_bit_generator();
-        dcc_receive();
-
-        if (semaphor_query(C_Received) )
-          {
-            if (analyze_message(&incoming) == 2)     // MyAdr empfangen
-              {
-                port_action(ReceivedCommand, ReceivedActivate);
-              }
-            semaphor_get(C_Received);
-          }
-        if (semaphor_query(C_DoSave) )
-          {
-            semaphor_get(C_DoSave);
-            if (JUMPER_FITTED)
-              {
-                my_eeprom_write_byte(&CV.LastState, PORTB);   
-              } 
-          } 
-        // if (PROG_PRESSED) DoProgramming();         
-      }
- 
-  }
-
-
-#endif
+// SIMULATION 2 (dcc generator -> receive -> decode) has moved to the host
+// build: host/dcc_gen.c feeds the receiver ISR with timed half bits.
 //------------------------------------------------------------------------
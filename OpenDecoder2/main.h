@@ -31,5 +31,9 @@
 
 extern unsigned char PortState;            // this is the state to be saved
 
+extern unsigned char my_mode;              // CV33 MODE, read at start of main()
+
+void dispatch_message(unsigned char retval);    // perform the result of analyze_message()
+
 
 //--------------------------------------------------------------------------------------
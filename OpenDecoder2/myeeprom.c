@@ -1,9 +1,321 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      myeeprom.c
+// history:   2026-10-17          write back cache for the CV record,
+//                                wear levelled journal for state bytes
+//            2026-10-17          Loc of servo 3..8 (SERVO_MUX) journaled
+//
+//------------------------------------------------------------------------
+//
+// purpose:   eeprom access for the decoder
+//
+//            EEPROM_CACHE == TRUE:
+//            The CV record is kept in RAM (eec_shadow). Reads are served
+//            from RAM, writes only mark the byte dirty. The main loop calls
+//            my_eeprom_background(), which starts one eeprom write
+//            if the eeprom is idle - so no caller waits for the 8,5ms
+//            write time.
+//
+//            State bytes which change on every action (LastState,
+//            servo locations) are not written to their CV cell; instead
+//            an entry (tag, value) is appended to EE_journal. On power up
+//            the journal is replayed over the CV record.
+//            Bit 7 of the tag is the pass of the journal; the journal
+//            ends at the first entry with the wrong pass or an invalid id.
+//            When the journal is full, the state bytes are folded into
+//            their CV cells, then the pass is toggled and entry 0 gets
+//            an end mark of the new pass.
+//            -> a CV cell of a state byte is written once per EEJ_SIZE
+//               changes instead of every change.
+//
+//            Addresses outside of the CV record (servo curves) are
+//            passed to the eeprom directly.
+//
+//            my_eeprom_flush() waits until everything is written; it is
+//            used before an ACK in service mode and before a restart.
+//
+//------------------------------------------------------------------------
+
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <inttypes.h>
 #include <avr/pgmspace.h>        // put var to program memory
 #include <avr/io.h>
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "config.h"
+#include "myeeprom.h"
+
+#if (EEPROM_CACHE == TRUE)
+
+#define EEC_SIZE    sizeof(t_cv_record)
+
+// index into the shadow is a char
+typedef char eec_size_check[(sizeof(t_cv_record) <= 255) ? 1 : -1];
+
+static unsigned char eec_shadow[EEC_SIZE];                  // copy of CV
+static unsigned char eec_dirty[(EEC_SIZE + 7) / 8];         // 1 = not yet in eeprom
+static unsigned char eec_count;                             // number of dirty bytes
+static unsigned char eec_scan;                              // next index for flush
+
+//------------------------------------------------------------------------
+// journal for the state bytes
+
+#define EEJ_SIZE    32                      // entries
+
+typedef struct
+  {
+    unsigned char value;                    // written first
+    unsigned char tag;                      // pass | (id+1); written last
+  } t_eej_entry;
+
+t_eej_entry EE_journal[EEJ_SIZE] EEMEM =
+  {
+    [0 ... EEJ_SIZE-1] = { 0xFF, 0xFF },    // erased: invalid id
+  };
+
+static const unsigned char eej_hot[] PROGMEM =      // offsets in t_cv_record
+  {
+    offsetof(t_cv_record, LastState),
+    #if (SERVO_ENABLED == TRUE)
+    offsetof(t_cv_record, Sv1_Loc),
+    offsetof(t_cv_record, Sv2_Loc),
+    offsetof(t_cv_record, Last_Pos),
+    #endif
+    #if (SERVO_MUX == TRUE)
+    offsetof(t_cv_record, Sv3_8) + 0*12 + 6,        // Loc of servo 3..8
+    offsetof(t_cv_record, Sv3_8) + 1*12 + 6,
+    offsetof(t_cv_record, Sv3_8) + 2*12 + 6,
+    offsetof(t_cv_record, Sv3_8) + 3*12 + 6,
+    offsetof(t_cv_record, Sv3_8) + 4*12 + 6,
+    offsetof(t_cv_record, Sv3_8) + 5*12 + 6,
+    #endif
+  };
+
+#define EEJ_HOT     (sizeof(eej_hot) / sizeof(eej_hot[0]))
+#define EEJ_PASS    0x80
+
+// id+1 is 7 bits of the tag; 0x7F (erased tag 0xFF) must stay invalid
+typedef char eej_hot_check[(EEJ_HOT < 0x7F) ? 1 : -1];
+
+#if (SERVO_MUX == TRUE)
+// Loc is the 7th of the 12 CVs of a servo (as Sv1_Loc in Sv1_minL..Sv1_Frame)
+typedef char eej_loc_check[(offsetof(t_cv_record, Sv1_Loc) - offsetof(t_cv_record, Sv1_minL) == 6) ? 1 : -1];
+#endif
+
+enum eej_states
+  {
+    EEJ_IDLE,
+    EEJ_TAG,                                // value is written, tag pending
+    EEJ_FOLD,                               // journal full, writing the CV cells
+  };
+
+static struct
+  {
+    unsigned char state;
+    unsigned char pass;                     // 0 or EEJ_PASS
+    unsigned char write;                    // next free entry
+    unsigned char tag;                      // pending tag (EEJ_TAG)
+    unsigned char fold;                     // current index (EEJ_FOLD)
+  } eej;
+
+
+static unsigned char eej_lookup(unsigned char index)     // ret: id+1 or 0
+  {
+    unsigned char i;
+
+    for (i=0; i<EEJ_HOT; i++)
+      {
+        if (pgm_read_byte(&eej_hot[i]) == index) return(i+1);
+      }
+    return(0);
+  }
+
+static void eec_clear_dirty(unsigned char index)
+  {
+    unsigned char mask = 1 << (index & 7);
+
+    if (eec_dirty[index >> 3] & mask)
+      {
+        eec_dirty[index >> 3] &= ~mask;
+        eec_count--;
+      }
+  }
+
+
+//------------------------------------------------------------------------
+// load CV and replay the journal; must be called before any CV access
+
+void my_eeprom_init(void)
+  {
+    unsigned char i, tag, id;
+
+    for (i=0; i<EEC_SIZE; i++)
+      {
+        eec_shadow[i] = eeprom_read_byte((unsigned char *)&CV + i);
+        eec_dirty[i >> 3] = 0;
+      }
+    eec_count = 0;
+    eec_scan = 0;
+
+    eej.state = EEJ_IDLE;
+    eej.pass = eeprom_read_byte(&EE_journal[0].tag) & EEJ_PASS;
+    for (i=0; i<EEJ_SIZE; i++)
+      {
+        tag = eeprom_read_byte(&EE_journal[i].tag);
+        if ((tag & EEJ_PASS) != eej.pass) break;
+        id = tag & ~EEJ_PASS;
+        if ((id == 0) || (id > EEJ_HOT)) break;
+        eec_shadow[pgm_read_byte(&eej_hot[id-1])] = eeprom_read_byte(&EE_journal[i].value);
+      }
+    eej.write = i;
+  }
+
+
+//------------------------------------------------------------------------
+// start (at most) one eeprom write; call it from the main loop
+
+void my_eeprom_background(void)
+  {
+    unsigned char i, id;
+    unsigned char *cell;
+
+    if (!eeprom_is_ready()) return;
+
+    switch(eej.state)
+      {
+        case EEJ_TAG:
+            eeprom_write_byte(&EE_journal[eej.write].tag, eej.tag);
+            eej.write++;
+            eej.state = EEJ_IDLE;
+            return;
+
+        case EEJ_FOLD:
+            while (eej.fold < EEJ_HOT)
+              {
+                i = pgm_read_byte(&eej_hot[eej.fold]);
+                cell = (unsigned char *)&CV + i;
+                if (eeprom_read_byte(cell) != eec_shadow[i])
+                  {
+                    eeprom_write_byte(cell, eec_shadow[i]);
+                    return;                             // check again next time
+                  }
+                eec_clear_dirty(i);                     // cell is up to date
+                eej.fold++;
+              }
+            eej.pass ^= EEJ_PASS;                       // old entries are void now:
+            eeprom_write_byte(&EE_journal[0].tag, eej.pass);  // mark (id 0) ends the journal
+            eej.write = 0;
+            eej.state = EEJ_IDLE;
+            return;
+      }
+
+    if (eec_count == 0) return;
+
+    i = eec_scan;
+    while (!(eec_dirty[i >> 3] & (1 << (i & 7))))
+      {
+        if (++i == EEC_SIZE) i = 0;
+      }
+    eec_scan = (i+1 == EEC_SIZE) ? 0 : i+1;
+
+    id = eej_lookup(i);
+    if (id)
+      {
+        if (eej.write == EEJ_SIZE)
+          {
+            eej.fold = 0;
+            eej.state = EEJ_FOLD;
+            return;
+          }
+        eec_clear_dirty(i);
+        eeprom_write_byte(&EE_journal[eej.write].value, eec_shadow[i]);
+        eej.tag = eej.pass | id;
+        eej.state = EEJ_TAG;
+      }
+    else
+      {
+        eec_clear_dirty(i);
+        cell = (unsigned char *)&CV + i;
+        if (eeprom_read_byte(cell) != eec_shadow[i])
+          {
+            eeprom_write_byte(cell, eec_shadow[i]);
+          }
+      }
+  }
+
+
+//------------------------------------------------------------------------
+// write all pending bytes, return when the eeprom is idle
+
+void my_eeprom_flush(void)
+  {
+    while (eec_count || (eej.state != EEJ_IDLE))
+      {
+        my_eeprom_background();
+        HOST_WAIT();
+      }
+    eeprom_busy_wait();
+  }
+
+
+void my_eeprom_write_byte(uint8_t *__p, uint8_t __value)
+  {
+    unsigned char i;
+
+    if ((__p >= (uint8_t *)&CV) && (__p < (uint8_t *)&CV + EEC_SIZE))
+      {
+        i = __p - (uint8_t *)&CV;
+        if (eec_shadow[i] != __value)
+          {
+            eec_shadow[i] = __value;
+            if (!(eec_dirty[i >> 3] & (1 << (i & 7))))
+              {
+                eec_dirty[i >> 3] |= (1 << (i & 7));
+                eec_count++;
+              }
+          }
+      }
+    else
+      {
+        eeprom_write_byte(__p, __value);
+      }
+  }
+
+
+uint8_t my_eeprom_read_byte(const uint8_t *__p)
+  {
+    if ((__p >= (const uint8_t *)&CV) && (__p < (const uint8_t *)&CV + EEC_SIZE))
+      {
+        return(eec_shadow[__p - (const uint8_t *)&CV]);
+      }
+    return(eeprom_read_byte(__p));
+  }
+
+#else  // (EEPROM_CACHE == TRUE)
+
+void my_eeprom_init(void)
+  {
+  }
+
+void my_eeprom_background(void)
+  {
+  }
+
+void my_eeprom_flush(void)
+  {
+    eeprom_busy_wait();
+  }
 
 void my_eeprom_write_byte(uint8_t *__p, uint8_t __value)
   {
@@ -16,3 +328,4 @@ uint8_t my_eeprom_read_byte(const uint8_t *__p)
     return(eeprom_read_byte(__p));
   }
 
+#endif // (EEPROM_CACHE == TRUE)
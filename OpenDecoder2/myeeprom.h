@@ -5,3 +5,12 @@ uint8_t my_eeprom_read_byte(const uint8_t *__p);
 
 
 void my_eeprom_write_byte(uint8_t *__p, uint8_t __value);
+
+
+// write back cache (see myeeprom.c)
+
+void my_eeprom_init(void);                  // load CV, call first
+
+void my_eeprom_background(void);            // call from main loop
+
+void my_eeprom_flush(void);                 // wait until all is written
@@ -29,6 +29,15 @@
 //            2007-01-09 V0.7 kw Feedback lines are backdriven just before
 //                               reading - to load the lines and not to
 //                               read just random noise.                   
+//            2026-10-17          timeout of a running ACK (no dcc)
+//            2026-10-17          timers in a deadline list (port_timer),
+//                               the tick handles only expired outputs
+//            2026-10-17          timer1 period is SERVO_FRAME, the timetick
+//                               is every SERVO_FRAMES periods
+//            2026-10-17          TIMER1_OVF with ISR_NOBLOCK: INT0 takes its
+//                               timestamp in software (ALTERNATE_RECEIVE 2)
+//            2026-10-17          ACK timeout after the duration of the ACK
+//                               instead of 2 timeticks
 //
 // tests:     2007-04-14 kw: feedback tested, FBM = 0,1; Magnet coils
 //
@@ -97,7 +106,9 @@
 // out_pwm controls outputs, monoflop pulses and toggling operations
 //
 
-volatile t_out_pwm out_pwm[8];
+volatile t_out_pwm out_pwm[PORT_OUTPUTS];
+
+static unsigned char timer_head = PORT_NONE;    // first output to expire
 
 
 // control structure for turnouts
@@ -199,6 +210,65 @@ void enable_timer_interrupt(void)
   }
 
 
+//------------------------------------------------------------------------------
+// Deadline list of the output timers
+//
+// Only outputs with a running timer are linked (out_pwm[].next), sorted by
+// expiry; out_pwm[].rest is the number of ticks after the previous entry.
+// So the tick decrements only the first entry and touches an output only
+// when its time has come - independent of the number of outputs.
+// Must run with the timer interrupt disabled (or within it).
+
+static void timer_remove(unsigned char port)
+  {
+    unsigned char prev = PORT_NONE;
+    unsigned char p = timer_head;
+    unsigned char next;
+
+    while (p != PORT_NONE)
+      {
+        if (p == port)
+          {
+            next = out_pwm[p].next;
+            if (next != PORT_NONE) out_pwm[next].rest += out_pwm[p].rest;
+            if (prev == PORT_NONE) timer_head = next;
+            else                   out_pwm[prev].next = next;
+            return;
+          }
+        prev = p;
+        p = out_pwm[p].next;
+      }
+  }
+
+static void timer_insert(unsigned char port, unsigned char ticks)
+  {
+    unsigned char prev = PORT_NONE;
+    unsigned char p = timer_head;
+
+    while ((p != PORT_NONE) && (out_pwm[p].rest <= ticks))
+      {                                         // equal times: in order of insertion
+        ticks -= out_pwm[p].rest;
+        prev = p;
+        p = out_pwm[p].next;
+      }
+    out_pwm[port].rest = ticks;
+    out_pwm[port].next = p;
+    if (p != PORT_NONE) out_pwm[p].rest -= ticks;
+    if (prev == PORT_NONE) timer_head = port;
+    else                   out_pwm[prev].next = port;
+  }
+
+void port_timer(unsigned char port, unsigned char ticks)
+  {
+    unsigned char enabled = TIMSK & (1<<TOIE1);     // may be called with timer int disabled
+
+    disable_timer_interrupt();
+    timer_remove(port);
+    if (ticks) timer_insert(port, ticks);
+    if (enabled) enable_timer_interrupt();
+  }
+
+
 #if (NEON_ENABLED == TRUE)
 
 unsigned char seed = 0xAA;             // var for prbs
@@ -305,7 +375,7 @@ volatile unsigned char isr_ratio;       // this is the running var for tick_rati
 //
 // init_port_engine
 //   initializes the output of the decoder 
-//   a) setup timer (with TICK_PERIOD)
+//   a) setup timer (with SERVO_FRAME, the tick is every SERVO_FRAMES periods)
 //   b) load values for port states from eeprom
 //   c) preload outputs
 
@@ -329,21 +399,21 @@ void init_port_engine(void)
     #endif
 
 
-    // check TICK_PERIOD and F_CPU
+    // check SERVO_FRAME and F_CPU
 
-    #if (F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER) > 65535L
-      #warning: overflow in ICR1 - check TICK_PERIOD and F_CPU
+    #if (F_CPU / 1000000L * SERVO_FRAME / T1_PRESCALER) > 65535L
+      #warning: overflow in ICR1 - check SERVO_FRAME and F_CPU
       #warning: suggestion: use a larger T1_PRESCALER
     #endif    
-    #if (F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER) < 5000L
-      #warning: resolution accuracy in ICR1 too low - check TICK_PERIOD and F_CPU
+    #if (F_CPU / 1000000L * SERVO_FRAME / T1_PRESCALER) < 5000L
+      #warning: resolution accuracy in ICR1 too low - check SERVO_FRAME and F_CPU
       #warning: suggestion: use a smaller T1_PRESCALER
     #endif    
 
     // Timer 1 runs in FAST-PWM-Mode with ICR1 as TOP-Value (WGM13:0 = 14).
     // note: due to a bug in AVRstudio this can't be simulated !!
 
-    ICR1 = F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER ;  
+    ICR1 = F_CPU / 1000000L * SERVO_FRAME / T1_PRESCALER ;  
 
     OCR1A = F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER / 20;  // removed 24.12.2008 ???
     OCR1B = F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER / 15;   
@@ -380,6 +450,8 @@ void init_port_engine(void)
       
 
     timerval = 0;
+    frameval = 0;
+    timer_head = PORT_NONE;                 // no timer running
 
     #if (PORT_ENABLED == TRUE)
       {
@@ -455,141 +527,143 @@ void init_port_engine(void)
 //
 // Howto:    Timer1 (with prescaler 8 and 16 bit total count) triggers
 //           an interrupt every TICK_PERIOD (=20ms @8MHz);
-//           this interrupt decrements out_pwm.rest of every port.
-//           if out_pwm touches 0 a new value is reloaded.
+//           this interrupt decrements out_pwm.rest of the first port
+//           in the deadline list. Each port whose time has come is
+//           processed by port_expired(); the returned time reloads it.
 //           This result in flexible programmable timing of PORTB.
 // 
-  
 
-ISR(TIMER1_OVF_vect)                        // Timer1 Overflow Int
-  {
-    
-    disable_timer_interrupt();
-    
-    sei();                                  // allow DCC interrupt
+#if (NEON_ENABLED == TRUE)
 
-    timerval++;                             // advance global clock
+// returns the time to the next change of this port, 0: none
+static inline unsigned char port_expired(unsigned char port)   __attribute__((always_inline));
+unsigned char port_expired(unsigned char port)
+  {
+    unsigned char mask = 1 << port;
+    unsigned char my_val;
 
-    #if (NEON_ENABLED == TRUE)
-     {
-       unsigned char port;
-       unsigned char mask; 
-       unsigned char my_time,my_val;
-       t_mode  my_mode; 
-       
-       if (--isr_ratio == 0)
-          {
-            isr_ratio = tick_ratio;             // reload divider 
-            mask = 1;
-            for (port=0; port<8; port++)
+    switch (out_pwm[port].mode)
+      {
+        case DELAY_TO_ON:
+            OUTPUT_PORT |= mask;
+            break;
+        case DELAY_TO_OFF:
+            OUTPUT_PORT &= ~mask;
+            break;
+        case BLINK_IT:
+            if (OUTPUT_PORT & mask)
+              { // bit was on
+                OUTPUT_PORT &= ~mask;
+              }
+            else
               {
-                my_mode = out_pwm[port].mode;
-                my_val = out_pwm[port].val;
-                my_time = out_pwm[port].rest;
-                switch (my_mode)
-                  {
-                    case DELAY_TO_ON:
-                        if (my_time !=0) 
-                          {
-                            if (--my_time == 0)
-                              {
-                                OUTPUT_PORT |= mask;
-                              }
-                            out_pwm[port].rest = my_time;
-                          }
-                        break;
-                    case DELAY_TO_OFF:
-                        if (my_time !=0) 
-                          {
-                            if (--my_time == 0)
-                              {
-                                OUTPUT_PORT &= ~mask;
-                              }
-                            out_pwm[port].rest = my_time;
-                          }
-                        break;
-                    case BLINK_IT:
-                        if (my_time !=0) 
-                          {
-                            if (--my_time == 0)
-                              {
-                                if (OUTPUT_PORT & mask)
-                                  { // bit was on
-                                    OUTPUT_PORT &= ~mask;
-                                  }
-                                else
-                                  {
-                                    OUTPUT_PORT |= mask;
-                                  }
-                                my_time = BLINK_IT_VAL;   // reload, to blink again
-                              }
-                            out_pwm[port].rest = my_time;
-                          }
-                        break;
-                    case FLICKER:
-                        if (my_val !=0) 
-                          {
-                            if (--my_time == 0)
-                              {
-                                // load next bit
-                                my_val = my_val >> 1;
-                                if (my_val == 0) 
-                                  {
-                                    // all flicker bits done - turn on port
-                                    OUTPUT_PORT |= mask;
-                                  }
-                                else
-                                  {
-                                    if (my_val & 0x01)
-                                      { 
-                                        OUTPUT_PORT |= mask;
-                                        my_time = 1;
-                                      }
-                                    else
-                                      {
-                                        OUTPUT_PORT &= ~mask;
-                                        my_time = my_val & 0x07;     // new delay = random + 5 extra
-                                        my_time += 10;
-                                      }
-                                  }
-                              }
-                            out_pwm[port].rest = my_time;
-                            out_pwm[port].val = my_val;
-                          }
-                        break;
-                  }
-                 mask = mask << 1;                  // do *not* calc mask from port
+                OUTPUT_PORT |= mask;
+              }
+            return(BLINK_IT_VAL);               // reload, to blink again
+        case FLICKER:
+            my_val = out_pwm[port].val;
+            if (my_val == 0) break;
+            // load next bit
+            my_val = my_val >> 1;
+            out_pwm[port].val = my_val;
+            if (my_val == 0) 
+              {
+                // all flicker bits done - turn on port
+                OUTPUT_PORT |= mask;
+              }
+            else if (my_val & 0x01)
+              { 
+                OUTPUT_PORT |= mask;
+                return(1);
               }
+            else
+              {
+                OUTPUT_PORT &= ~mask;
+                return((my_val & 0x07) + 10);   // new delay = random + 10 extra
+              }
+            break;
+      }
+    return(0);
+  }
+
+#elif (PORT_ENABLED == TRUE)
+
+// toggle the port; returns the time of the new state, 0: keep it
+static inline unsigned char port_expired(unsigned char port)   __attribute__((always_inline));
+unsigned char port_expired(unsigned char port)
+  {
+    unsigned char mask = 1 << port;
+
+    if (OUTPUT_PORT & mask)
+      { // bit was on
+        OUTPUT_PORT &= ~mask;
+        return(out_pwm[port].offtime);
+      }
+    OUTPUT_PORT |= mask;
+    return(out_pwm[port].ontime);
+  }
+
+#endif
+
+#if (PORT_OUTPUTS > 8)
+  #error: port_expired() drives OUTPUT_PORT only - add the output for ports 8 and up
+#endif
+
+#if (SERVO_FRAMES > 1)
+static unsigned char frame_count;           // timer1 periods in this timetick
+#endif
+
+// ISR_NOBLOCK: the prologue alone would delay INT0 by ~40 cycles; the edge
+// receiver takes its timestamp in software (see dcc_receiver.c).
+ISR(TIMER1_OVF_vect, ISR_NOBLOCK)           // Timer1 Overflow Int
+  {
+    frameval++;                             // next servo frame
+
+    if (dcc_ack.state != ACK_IDLE)          // no dcc -> receiver can't end the ACK
+      {
+        cli();                              // INT0 may restart the state
+        if (dcc_ack.timeout <= ICR1 + 1)    // ends in the period just over
+          {
+            DCC_ACK_OFF;
+            dcc_ack.read = dcc_ack.write;
+            dcc_ack.state = ACK_IDLE;
           }
+        else dcc_ack.timeout -= ICR1 + 1;
+        sei();
       }
-    #elif (PORT_ENABLED == TRUE)
+
+    #if (SERVO_FRAMES > 1)
+        if (++frame_count < SERVO_FRAMES) return;   // no timetick in this period
+        frame_count = 0;
+    #endif
+
+    disable_timer_interrupt();              // interrupts are enabled (ISR_NOBLOCK)
+
+    timerval++;                             // advance global clock
+
+    #if ((NEON_ENABLED == TRUE) || (PORT_ENABLED == TRUE))
       {
         unsigned char port;
-        unsigned char mask; 
-        unsigned char my_rest; 
-       
-        mask = 1;
-        for (port=0; port<8; port++)
+        unsigned char ticks;
+
+        #if (NEON_ENABLED == TRUE)
+        if (--isr_ratio == 0)
+        #endif
           {
-            my_rest = out_pwm[port].rest;       // use a local variable to force
-            if (my_rest !=0)                    // compiler to tiny code
+            #if (NEON_ENABLED == TRUE)
+                isr_ratio = tick_ratio;             // reload divider
+            #endif
+            if (timer_head != PORT_NONE)
               {
-                if (--my_rest == 0)
+                out_pwm[timer_head].rest--;         // first entry is always >= 1
+                while ((timer_head != PORT_NONE) && (out_pwm[timer_head].rest == 0))
                   {
-                     if (OUTPUT_PORT & mask)
-                      { // bit was on
-                        my_rest = out_pwm[port].offtime;
-                        OUTPUT_PORT &= ~mask;
-                      }
-                    else
-                      {
-                        my_rest = out_pwm[port].ontime;
-                        OUTPUT_PORT |= mask;
-                      }
+                    port = timer_head;
+                    timer_head = out_pwm[port].next;
+                    ticks = port_expired(port);
+                    if (ticks) timer_insert(port, ticks);
                   }
-                out_pwm[port].rest = my_rest;
               }
-             mask = mask << 1;                  // do *not* calc mask from port
           }
       }
     #endif
@@ -756,9 +830,9 @@ void perform_action(const struct t_action *pData)
     if (ctrl & (1<<7)) OUTPUT_PORT |= mask;
     else               OUTPUT_PORT &= ~mask;
     
-    out_pwm[port].rest    = pgm_read_byte(&pData->rest);
     out_pwm[port].ontime  = pgm_read_byte(&pData->ontime);
     out_pwm[port].offtime = pgm_read_byte(&pData->offtime);
+    port_timer(port, pgm_read_byte(&pData->rest));
     sei(); 
   }
 
@@ -812,8 +886,8 @@ void port_action(unsigned int Command, unsigned char Activate)
         
         if (myCommand == 0)
           {
-            out_pwm[0].rest = turnout[0].pulse_duration;         
-            out_pwm[1].rest = 0;
+            port_timer(0, turnout[0].pulse_duration);         
+            port_timer(1, 0);
             turnout[0].position = 0;         
             output(PB0,1);
             output(PB1,0);
@@ -825,8 +899,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 1)
           {
-            out_pwm[1].rest = turnout[0].pulse_duration;         
-            out_pwm[0].rest = 0;         
+            port_timer(1, turnout[0].pulse_duration);         
+            port_timer(0, 0);         
             turnout[0].position = 1;         
             output(PB0,0);
             output(PB1,1);
@@ -838,8 +912,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 2)
           {
-            out_pwm[2].rest = turnout[1].pulse_duration;         
-            out_pwm[3].rest = 0;         
+            port_timer(2, turnout[1].pulse_duration);         
+            port_timer(3, 0);         
             turnout[1].position = 0;         
             output(PB2,1);
             output(PB3,0);
@@ -851,8 +925,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 3)
           {
-            out_pwm[3].rest = turnout[1].pulse_duration;         
-            out_pwm[2].rest = 0;         
+            port_timer(3, turnout[1].pulse_duration);         
+            port_timer(2, 0);         
             turnout[1].position = 1;         
             output(PB2,0);
             output(PB3,1);
@@ -865,8 +939,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 4)
           {
-            out_pwm[4].rest = turnout[2].pulse_duration;         
-            out_pwm[5].rest = 0;         
+            port_timer(4, turnout[2].pulse_duration);         
+            port_timer(5, 0);         
             turnout[2].position = 0;         
             output(PB4,1);
             output(PB5,0);
@@ -878,8 +952,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 5)
           {
-            out_pwm[5].rest = turnout[2].pulse_duration;         
-            out_pwm[4].rest = 0;         
+            port_timer(5, turnout[2].pulse_duration);         
+            port_timer(4, 0);         
             turnout[2].position = 1;         
             output(PB4,0);
             output(PB5,1);
@@ -891,8 +965,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 6)
           {
-            out_pwm[6].rest = turnout[3].pulse_duration;         
-            out_pwm[7].rest = 0;         
+            port_timer(6, turnout[3].pulse_duration);         
+            port_timer(7, 0);         
             turnout[3].position = 0;         
             output(PB6,1);
             output(PB7,0);
@@ -904,8 +978,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else // (myCommand == 7)
           {
-            out_pwm[7].rest = turnout[3].pulse_duration;         
-            out_pwm[6].rest = 0;         
+            port_timer(7, turnout[3].pulse_duration);         
+            port_timer(6, 0);         
             turnout[3].position = 1;         
             output(PB6,0);
             output(PB7,1);
@@ -925,8 +999,8 @@ void port_action(unsigned int Command, unsigned char Activate)
         
         if (myCommand == 0)
           {
-            out_pwm[0].rest = 0;         // stop every timer
-            out_pwm[1].rest = 0;
+            port_timer(0, 0);         // stop every timer
+            port_timer(1, 0);
             if (turnout[0].pulse_duration != 0)
               {                          // in pulse mode: allways turn off both coils
                 output(PB0,0);
@@ -935,8 +1009,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 1)
           {
-            out_pwm[1].rest = 0;         
-            out_pwm[0].rest = 0;         
+            port_timer(1, 0);         
+            port_timer(0, 0);         
             if (turnout[0].pulse_duration != 0)
               {
                 output(PB0,0);
@@ -945,8 +1019,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 2)
           {
-            out_pwm[2].rest = 0;         
-            out_pwm[3].rest = 0;         
+            port_timer(2, 0);         
+            port_timer(3, 0);         
             if (turnout[1].pulse_duration != 0)
               {
                 output(PB2,0);
@@ -955,8 +1029,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 3)
           {
-            out_pwm[3].rest = 0;         
-            out_pwm[2].rest = 0;         
+            port_timer(3, 0);         
+            port_timer(2, 0);         
             if (turnout[1].pulse_duration != 0)
               {
                 output(PB2,0);
@@ -965,8 +1039,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 4)
           {
-            out_pwm[4].rest = 0;         
-            out_pwm[5].rest = 0;         
+            port_timer(4, 0);         
+            port_timer(5, 0);         
             if (turnout[2].pulse_duration != 0)
               {
                 output(PB4,0);
@@ -975,8 +1049,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 5)
           {
-            out_pwm[5].rest = 0;         
-            out_pwm[4].rest = 0;         
+            port_timer(5, 0);         
+            port_timer(4, 0);         
             if (turnout[2].pulse_duration != 0)
               {
                 output(PB4,0);
@@ -985,8 +1059,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else if (myCommand == 6)
           {
-            out_pwm[6].rest = 0;         
-            out_pwm[7].rest = 0;         
+            port_timer(6, 0);         
+            port_timer(7, 0);         
             if (turnout[3].pulse_duration != 0)
               {
                 output(PB6,0);
@@ -995,8 +1069,8 @@ void port_action(unsigned int Command, unsigned char Activate)
           }
         else // (myCommand == 7)
           {
-            out_pwm[7].rest = 0;         
-            out_pwm[6].rest = 0;         
+            port_timer(7, 0);         
+            port_timer(6, 0);         
             if (turnout[3].pulse_duration != 0)
               {
                 output(PB6,0);
@@ -1196,7 +1270,7 @@ void neon_action(unsigned int Command)
           {
             out_pwm[myTurnout].mode = DELAY_TO_ON; 
           }
-        out_pwm[myTurnout].rest  = 1;    
+        port_timer(myTurnout, 1);    
       }
     else if (MyOpMode == 6)                         // blink all bits individually
       {
@@ -1210,7 +1284,7 @@ void neon_action(unsigned int Command)
           {
             out_pwm[myTurnout].mode = BLINK_IT; 
           }
-        out_pwm[myTurnout].rest  = 1;
+        port_timer(myTurnout, 1);
 
       }
     else if (MyOpMode == 5)
@@ -1233,7 +1307,7 @@ void neon_action(unsigned int Command)
             for (i=0; i<8; i++)
               {
                 out_pwm[i].mode = DELAY_TO_ON;
-                out_pwm[i].rest  = 1;
+                port_timer(i, 1);
               }
           }
         else if (myCommand == 2)
@@ -1242,7 +1316,7 @@ void neon_action(unsigned int Command)
             for (i=0; i<8; i++)
               {
                 out_pwm[i].mode = DELAY_TO_OFF;
-                out_pwm[i].rest  = new_random();
+                port_timer(i, new_random());
               }   
           }
         else if (myCommand == 3)
@@ -1251,7 +1325,7 @@ void neon_action(unsigned int Command)
             for (i=0; i<8; i++)
               {
                 out_pwm[i].mode = DELAY_TO_ON;
-                out_pwm[i].rest  = new_random();
+                port_timer(i, new_random());
               }      
           }
         else if (myCommand == 4)
@@ -1265,8 +1339,7 @@ void neon_action(unsigned int Command)
               {
                 out_pwm[i].mode = FLICKER;
                 out_pwm[i].val  = new_random();
-                out_pwm[i].rest  = new_random() & 0x0f;
-                out_pwm[i].rest  += 1;
+                port_timer(i, (new_random() & 0x0f) + 1);
               }     
            }
          else if (myCommand == 6)
@@ -16,6 +16,7 @@
 // webpage:   http://www.opendcc.de
 // history:   2007-02-14 V0.01 kw copied from opendecoder.c
 //            2011-11-09 V0.02 kw added NEON_ENABLED
+//            2026-10-17          port_timer(), deadline list of the timers
 //
 //------------------------------------------------------------------------
 //
@@ -42,11 +43,16 @@ typedef enum {DELAY_TO_ON,      // Port hat Einschaltverz
              } t_mode;
 
 
+// rest and next are owned by the timing engine: a port with a running
+// timer is in a list sorted by expiry, rest counts the ticks after the
+// previous entry. Start and stop timers only with port_timer().
+
 #if (NEON_ENABLED == TRUE)
     typedef struct
       {
         t_mode mode;                // This is the mode of this port bit 
-        unsigned char rest;         // current duration of state
+        unsigned char rest;         // current duration of state (delta to previous timer)
+        unsigned char next;         // next timer to expire, PORT_NONE: last
         unsigned char val;          // current value for special operation
         unsigned char ontime;       // ontime (to be reloaded)
         unsigned char offtime;      // offtime (to be reloaded)
@@ -54,13 +60,22 @@ typedef enum {DELAY_TO_ON,      // Port hat Einschaltverz
 #else
     typedef struct
       {
-        unsigned char rest;         // time to keep the actual state (given in ticks (20ms)
+        unsigned char rest;         // time to keep the actual state (ticks (20ms), delta to previous timer)
+        unsigned char next;         // next timer to expire, PORT_NONE: last
         unsigned char ontime;       // ontime (to be reloaded)
         unsigned char offtime;      // offtime (to be reloaded)
       } t_out_pwm;
 #endif
 
-extern volatile t_out_pwm out_pwm[8];
+#define PORT_OUTPUTS    8           // logical outputs of the timing engine (up to 254);
+                                    // the tick does not depend on this number
+#define PORT_NONE       0xFF
+
+extern volatile t_out_pwm out_pwm[PORT_OUTPUTS];
+
+// (re)start the timer of an output: after ticks (20ms) the output is
+// toggled (port engine) or set by its mode (neon); 0: stop the timer
+void port_timer(unsigned char port, unsigned char ticks);
 
 // general support routines
 
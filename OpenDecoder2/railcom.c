@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      railcom.c
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   RailCom (BiDi) transmitter for the accessory decoder
+//
+// howto:     The receiver (ALTERNATE_RECEIVE 2) knows the time of the
+//            edge which ends the end bit of a packet (t_end, TCNT1);
+//            after a packet with correct XOR it calls railcom_packet_end(),
+//            which checks the address and starts timer0 (ctc, 1us);
+//            TIMER0_COMP then runs through:
+//
+//              t_end +  80us: channel 1 - adr_high / adr_low (ID 1, 2),
+//                             alternating with each cutout
+//              t_end + 193us: channel 2 - only if the packet was for us:
+//                             PoM answer (ID 0) or ACK
+//              t_end + 283us: transmitter off
+//
+//            Cutout detection: the command station sends 26..32us of the
+//            next bit, then the track is switched off. Before each
+//            channel the last dcc edge (dcc_last_edge) is checked - an
+//            edge later than RC_T_TCS_MAX after t_end means there is no
+//            cutout, then nothing is sent.
+//
+//            The datagrams are 4/8 encoded in main (railcom_load,
+//            railcom_pom); the ISR only copies two bytes to the uart.
+//
+// enable:    CV28 (BiDi) bit 0: channel 1, bit 1: channel 2
+//            (CV29 bit 3 is not used, CV29 is write protected here)
+//
+// used hw resources:
+//
+//      Timer0: cutout timing (free with ALTERNATE_RECEIVE 2)
+//      UART0:  250kBaud, 8N1 on TXD0 = RAILCOM
+//
+//------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>        // put var to program memory
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "config.h"
+#include "hardware.h"
+#include "dcc_receiver.h"
+#include "railcom.h"
+
+#if (RAILCOM_ENABLED == TRUE)
+
+#define RC_BAUD         250000L
+
+#define RC_ACK          0xF0            // ACK, not in the 4/8 table
+#define RC_ID_POM       0
+#define RC_ID_ADR_HIGH  1
+#define RC_ID_ADR_LOW   2
+
+volatile t_railcom railcom;
+
+// 4/8 code: 6 data bits -> 8 bit with 4 ones and 4 zeros
+static const unsigned char rc_code[64] PROGMEM =
+  {
+    0xAC, 0xAA, 0xA9, 0xA5, 0xA3, 0xA6, 0x9C, 0x9A,     // 0x00
+    0x99, 0x95, 0x93, 0x96, 0x8E, 0x8D, 0x8B, 0xB1,
+    0xB2, 0xB4, 0xB8, 0x74, 0x72, 0x6C, 0x6A, 0x69,     // 0x10
+    0x65, 0x63, 0x66, 0x5C, 0x5A, 0x59, 0x55, 0x53,
+    0x56, 0x4E, 0x4D, 0x4B, 0x47, 0x71, 0xE8, 0xE4,     // 0x20
+    0xE2, 0xD1, 0xC9, 0xC5, 0xD8, 0xD4, 0xD2, 0xCA,
+    0xC6, 0xCC, 0x78, 0x17, 0x1B, 0x1D, 0x1E, 0x2E,     // 0x30
+    0x36, 0x3A, 0x27, 0x2B, 0x2D, 0x35, 0x39, 0x33,
+  };
+
+// 12 bit datagram (4 bit id, 8 bit data) -> 2 bytes
+static void rc_encode(volatile unsigned char *dest, unsigned char id, unsigned char data)
+  {
+    dest[0] = pgm_read_byte(&rc_code[(id << 2) | (data >> 6)]);
+    dest[1] = pgm_read_byte(&rc_code[data & 0x3F]);
+  }
+
+
+void init_railcom(void)
+  {
+    railcom.state = RC_IDLE;
+    railcom.enable = 0;
+
+    PORTD |= (1<<RAILCOM);                      // idle: mark
+    DDRD |= (1<<RAILCOM) | (1<<RAILCOM_ON);
+    RAILCOM_LED_OFF;
+
+    UCSR0B = 0;                                 // stop everything
+    UBRR0H = (uint8_t) ((F_CPU / (16 * RC_BAUD) - 1) >> 8);
+    UBRR0L = (uint8_t) (F_CPU / (16 * RC_BAUD) - 1);
+    UCSR0C = (1 << URSEL0)                      // must be one
+           | (0 << USBS0)                       // 1 stop bit
+           | (1 << UCSZ01)                      // 8 bit
+           | (1 << UCSZ00);
+    UCSR0A = (1 << TXC0);
+    // transmitter is enabled only during the cutout
+  }
+
+
+// addr: our decoder address (as in analyze_message)
+// bidi: CV28
+void railcom_load(unsigned int addr, unsigned char extended, unsigned char bidi)
+  {
+    cli();
+    railcom.enable = 0;                         // no cutout while we change it
+    sei();
+
+    if (extended)
+      {                                         // 10AAAAAA 0AAA0AA1, RCN-213
+        railcom.match0 = 0x80 | ((addr >> 2) & 0x3F);
+        railcom.mask1 = 0b11110111;
+        railcom.match1 = ((~addr >> 4) & 0x70) | ((addr & 0x03) << 1) | 0x01;
+      }
+    else
+      {                                         // 10AAAAAA 1AAACDDD
+        railcom.match0 = 0x80 | (addr & 0x3F);
+        railcom.mask1 = 0b11110000;
+        railcom.match1 = 0x80 | ((~addr >> 2) & 0x70);
+      }
+
+    rc_encode(railcom.ch1[0], RC_ID_ADR_HIGH, addr >> 8);
+    rc_encode(railcom.ch1[1], RC_ID_ADR_LOW, addr);
+
+    railcom.ch2_len = 0;
+    railcom.enable = bidi & 0x03;
+  }
+
+
+// answer to a PoM read or write; sent in channel 2 of the next packet
+// to our address (usually the repetition of the PoM command)
+void railcom_pom(unsigned char value)
+  {
+    unsigned char code[2];
+
+    rc_encode(code, RC_ID_POM, value);
+    cli();
+    railcom.ch2[0] = code[0];
+    railcom.ch2[1] = code[1];
+    railcom.ch2_len = 2;
+    sei();
+  }
+
+
+//------------------------------------------------------------------------
+// cutout timing
+
+static unsigned char rc_cutout(void)
+  {
+    unsigned int since;
+
+    since = dcc_last_edge - railcom.t_end;
+    if (dcc_last_edge < railcom.t_end) since += ICR1 + 1;
+    return(since < RC_TICKS(RC_T_TCS_MAX));
+  }
+
+static void rc_send(unsigned char data)
+  {
+    #if (HOST_BUILD == TRUE)
+        host_uart_tx(data);
+    #else
+        while (!(UCSR0A & (1<<UDRE0)));
+        UDR0 = data;
+    #endif
+  }
+
+static void rc_stop(void)
+  {
+    TCCR0 = 0;                                  // stop timer0
+    TIMSK &= ~(1 << OCIE0);
+    UCSR0B &= ~(1 << TXEN0);                    // TXD0 back to mark
+    RAILCOM_LED_OFF;
+    railcom.state = RC_IDLE;
+  }
+
+
+ISR(TIMER0_COMP_vect)
+  {
+    volatile unsigned char *data;
+
+    if (!rc_cutout() || (railcom.state == RC_WF_END))
+      {
+        rc_stop();
+        return;
+      }
+
+    if (railcom.state == RC_WF_CH1)
+      {
+        UCSR0B |= (1 << TXEN0);
+        RAILCOM_LED_ON;
+        if (railcom.enable & (1<<0))
+          {
+            data = railcom.ch1[railcom.ch1_toggle];
+            railcom.ch1_toggle ^= 1;
+            rc_send(data[0]);
+            rc_send(data[1]);
+          }
+        OCR0 = RC_TICKS(RC_T_CH2 - RC_T_CH1) - 1;
+        railcom.state = RC_WF_CH2;
+      }
+    else
+      {
+        if ((railcom.enable & (1<<1)) && railcom.addressed)
+          {
+            if (railcom.ch2_len)
+              {
+                rc_send(railcom.ch2[0]);
+                rc_send(railcom.ch2[1]);
+                railcom.ch2_len = 0;            // answer once
+              }
+            else
+              {
+                rc_send(RC_ACK);
+              }
+          }
+        OCR0 = RC_TICKS(RC_T_END - RC_T_CH2) - 1;
+        railcom.state = RC_WF_END;
+      }
+  }
+
+#endif // (RAILCOM_ENABLED == TRUE)
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      railcom.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   RailCom (BiDi) transmitter, see railcom.c
+//
+// howto:     Step 1: call init_railcom() before init_dcc_decode()
+//            Step 2: railcom_load() whenever address or CV28/29 change
+//                    (done by load_decoder_context())
+//            Step 3: the receiver calls railcom_packet_end() at the
+//                    end bit of every packet - this starts the cutout
+//                    timing on timer0.
+//            Step 4: railcom_pom(value) puts a PoM answer to channel 2
+//                    of the next packet to our address.
+//
+//------------------------------------------------------------------------
+#ifndef _RAILCOM_H_
+#define _RAILCOM_H_
+
+// timing, in us after the end of the packet end bit (RCN-217)
+
+#define RC_T_TCS_MAX        40          // cutout starts (26..32us), edges up to here are ok
+#define RC_T_CH1            80          // start of channel 1
+#define RC_T_CH2            193         // start of channel 2
+#define RC_T_END            (RC_T_CH2 + 90)  // 2 bytes sent, transmitter off
+
+#define RC_T0_PRESCALER     8           // timer0 for the cutout timing
+#define RC_TICKS(us)        (F_CPU / 1000000L * (us) / RC_T0_PRESCALER)
+
+#define RC_IDLE             0
+#define RC_WF_CH1           1
+#define RC_WF_CH2           2
+#define RC_WF_END           3
+
+typedef struct
+  {
+    unsigned char state;                // RC_x, changed by ISR
+    unsigned char enable;               // bit 0: channel 1, bit 1: channel 2
+    unsigned char match0;               // first byte of a packet to us
+    unsigned char mask1;                // second byte: (dcc[1] & mask1) == match1
+    unsigned char match1;
+    unsigned char addressed;            // current packet is for us
+    unsigned int  t_end;                // TCNT1 at the end of the end bit
+    unsigned char ch1_toggle;           // adr_high / adr_low
+    unsigned char ch1[2][2];            // encoded datagrams ID1, ID2
+    unsigned char ch2_len;              // 0: ACK, 2: ch2[]
+    unsigned char ch2[2];               // encoded PoM answer
+  } t_railcom;
+
+extern volatile t_railcom railcom;
+
+void init_railcom(void);
+
+void railcom_load(unsigned int addr, unsigned char extended, unsigned char bidi);
+
+void railcom_pom(unsigned char value);
+
+
+//------------------------------------------------------------------------
+// called by the receiver ISR at the edge which ends the packet end bit
+// dcc: message with correct XOR (checked by the receiver), t_end: TCNT1 of this edge
+
+static inline void railcom_packet_end(volatile unsigned char *dcc, unsigned int t_end)
+       __attribute__((always_inline));
+
+void railcom_packet_end(volatile unsigned char *dcc, unsigned int t_end)
+  {
+    unsigned int late;
+
+    if (!railcom.enable) return;
+    if (railcom.state != RC_IDLE) return;
+
+    railcom.addressed = (dcc[0] == railcom.match0)
+                     && ((dcc[1] & railcom.mask1) == railcom.match1);
+    railcom.t_end = t_end;
+
+    late = TCNT1 - t_end;                       // isr latency
+    if (TCNT1 < t_end) late += ICR1 + 1;
+    if (late >= RC_TICKS(RC_T_CH1) - 1) return; // too late for channel 1
+
+    TCNT0 = 0;
+    OCR0 = RC_TICKS(RC_T_CH1) - 1 - late;
+    TCCR0 = (0 << FOC0)
+          | (0 << WGM00)                        // wgm = 10: ctc, top = OCR0
+          | (0 << COM01)
+          | (0 << COM00)
+          | (1 << WGM01)
+          | (0 << CS02)                         // cs = 010: prescaler 8
+          | (1 << CS01)
+          | (0 << CS00);
+    TIFR = (1 << OCF0);
+    TIMSK |= (1 << OCIE0);
+    railcom.state = RC_WF_CH1;
+  }
+
+#endif // _RAILCOM_H_
@@ -15,6 +15,7 @@
 // contact:   kufer@gmx.de
 // webpage:   http://www.opendcc.de
 // history:   2010-09-14 V0.01 kw start
+//            2026-10-17          timers set with port_timer()
 //
 //
 //------------------------------------------------------------------------
@@ -118,13 +119,13 @@ static void  trigger_k1_normal(void)
   {
      disable_timer_interrupt(); 
      // OUT7: pulse, OUT6 off, OUT3 on, OUT2 off
-     out_pwm[7].rest = 3; // pulse_duration; 
+     port_timer(7, 3); // pulse_duration; 
      output(PB7,1);        
-     out_pwm[6].rest = 0;
+     port_timer(6, 0);
      output(PB6,0);        
-     out_pwm[3].rest = 0;
+     port_timer(3, 0);
      output(PB3,1);        
-     out_pwm[2].rest = 0;
+     port_timer(2, 0);
      output(PB2,0);        
      enable_timer_interrupt(); 
   }
@@ -133,13 +134,13 @@ static void  trigger_k1_invers(void)
   {
      disable_timer_interrupt(); 
      // OUT7 off, OUT6: pulse, OUT3 off, OUT2 on
-     out_pwm[7].rest = 0;
+     port_timer(7, 0);
      output(PB7,0);        
-     out_pwm[6].rest = 3; // pulse_duration; 
+     port_timer(6, 3); // pulse_duration; 
      output(PB6,1);        
-     out_pwm[3].rest = 0;
+     port_timer(3, 0);
      output(PB3,0);        
-     out_pwm[2].rest = 0;
+     port_timer(2, 0);
      output(PB2,1);        
      enable_timer_interrupt(); 
   }
@@ -148,13 +149,13 @@ static void  trigger_k2_normal(void)
   {
      disable_timer_interrupt(); 
      // OUT5: pulse, OUT4 off, OUT0 on, OUT1 off
-     out_pwm[5].rest = 3; // pulse_duration; 
+     port_timer(5, 3); // pulse_duration; 
      output(PB5,1);        
-     out_pwm[4].rest = 0;
+     port_timer(4, 0);
      output(PB4,0);        
-     out_pwm[0].rest = 0;
+     port_timer(0, 0);
      output(PB0,1);        
-     out_pwm[1].rest = 0;
+     port_timer(1, 0);
      output(PB1,0);        
      enable_timer_interrupt(); 
   }
@@ -163,13 +164,13 @@ static void trigger_k2_invers(void)
   {
      disable_timer_interrupt(); 
      // OUT5 off, OUT4: pulse, OUT0 off, OUT1 on
-     out_pwm[5].rest = 0;
+     port_timer(5, 0);
      output(PB5,0);        
-     out_pwm[4].rest = 3; // pulse_duration; 
+     port_timer(4, 3); // pulse_duration; 
      output(PB4,1);        
-     out_pwm[0].rest = 0;
+     port_timer(0, 0);
      output(PB0,0);        
-     out_pwm[1].rest = 0;
+     port_timer(1, 0);
      output(PB1,1);        
      enable_timer_interrupt(); 
   }
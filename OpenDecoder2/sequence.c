@@ -0,0 +1,236 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      sequence.c
+// history:   2026-10-17 V0.1 start
+//            2026-10-17          a sequence which ends is no longer saved
+//                                as running
+//
+//------------------------------------------------------------------------
+//
+// purpose:   flexible general purpose decoder for dcc
+//            here: light sequences (CV33 MODE = 6)
+//
+//            Effects like the construction site flasher (port*_bst in
+//            port_engine.c) are a small program of byte codes in
+//            EE_sequence (opcodes see sequence.h). The program is
+//            written with CV449..CV512, so new effects need no new
+//            firmware. It is copied to RAM at init and after each
+//            write of one of these CVs.
+//
+//            Up to SEQ_MAX sequences run at the same time, each with
+//            its own program counter, wait counter and loop counter.
+//            run_sequence() does one tick (20ms) per call: a sequence
+//            whose wait has elapsed runs until the next wait or end,
+//            but at most SEQ_STEPS instructions (the rest follows in the
+//            next tick) - so the time per tick is bounded, even for a
+//            program with a loop without wait.
+//            Ticks are counted (not sampled) - if the main loop is late,
+//            the next calls catch up.
+//
+//            Accessory commands:
+//              Command = 2*n   sequence n stops, its outputs turn off
+//              Command = 2*n+1 sequence n starts from the beginning
+//            The running sequences are saved in LastState and start
+//            again after reset; a sequence which has ended (SEQ_END or
+//            error) is removed from LastState.
+//
+//            A sequence with an invalid start address or code (address
+//            beyond SEQ_SIZE, unknown opcode) stops.
+//
+//------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <avr/pgmspace.h>        // put var to program memory
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+
+#include "config.h"
+#include "myeeprom.h"            // wrapper for eeprom
+#include "hardware.h"
+#include "main.h"
+#include "sequence.h"
+
+#if (SEQUENCE_ENABLED == TRUE)
+
+typedef struct
+  {
+    unsigned char pc;                   // next instruction
+    unsigned char wait;                 // ticks to wait before pc
+    unsigned char loop;                 // counter of SEQ_LOOP, 0: no loop active
+    unsigned char used;                 // outputs written by this sequence
+  } t_seq;
+
+static t_seq seq[SEQ_MAX];
+static unsigned char seq_running;       // bit n: sequence n runs
+static unsigned char seq_code[SEQ_SIZE];    // copy of EE_sequence
+static signed char last_seq_run;        // timerval of the last tick done
+static unsigned int seq_rnd = 0xACE1;   // state of the random generator
+
+
+// galois lfsr, x^16 + x^14 + x^13 + x^11 + 1
+static unsigned char seq_random(void)
+  {
+    unsigned char i;
+
+    for (i=0; i<8; i++)
+      {
+        if (seq_rnd & 1) seq_rnd = (seq_rnd >> 1) ^ 0xB400;
+        else             seq_rnd = seq_rnd >> 1;
+      }
+    return(seq_rnd);
+  }
+
+void sequence_load(void)
+  {
+    unsigned char i;
+
+    for (i=0; i<SEQ_SIZE; i++)
+      {
+        seq_code[i] = my_eeprom_read_byte(&EE_sequence[i]);
+      }
+  }
+
+static void seq_start(unsigned char n)
+  {
+    seq[n].pc = seq_code[n];            // start table
+    seq[n].wait = 0;
+    seq[n].loop = 0;
+    seq[n].used = 0;
+    seq_running |= (1<<n);
+  }
+
+static void seq_stop(unsigned char n)
+  {
+    seq_running &= ~(1<<n);
+    OUTPUT_PORT &= ~seq[n].used;
+  }
+
+// the sequence has ended by itself: don't start it again after reset
+static void seq_ended(void)
+  {
+    PortState = seq_running;
+    semaphor_set(C_DoSave);
+  }
+
+void init_sequence(void)
+  {
+    unsigned char n, last_state;
+
+    sequence_load();
+    seq_running = 0;
+    last_state = my_eeprom_read_byte(&CV.LastState);
+    for (n=0; n<SEQ_MAX; n++)
+      {
+        if (last_state & (1<<n)) seq_start(n);
+      }
+    PortState = seq_running;
+    OUTPUT_PORT = 0;
+    last_seq_run = timerval;
+  }
+
+void sequence_action(unsigned int Command)
+  {
+    unsigned char n;
+
+    if (Command >= 2 * SEQ_MAX) return;             // not our Address
+    n = Command >> 1;
+
+    if (Command & 1) seq_start(n);
+    else             seq_stop(n);
+
+    PortState = seq_running;
+    semaphor_set(C_DoSave);
+  }
+
+
+//---------------------------------------------------------------------------
+// interpreter: run sequence n until the next wait, at most SEQ_STEPS
+// instructions
+
+static void seq_step(unsigned char n)
+  {
+    t_seq *s = &seq[n];
+    unsigned char steps, op, arg, mask;
+
+    for (steps=0; steps<SEQ_STEPS; steps++)
+      {
+        if (s->pc >= SEQ_SIZE)
+          {
+            seq_stop(n);
+            seq_ended();
+            return;
+          }
+        op = seq_code[s->pc++];
+        arg = (s->pc < SEQ_SIZE) ? seq_code[s->pc] : 0;     // second byte, if any
+        mask = 1 << (op & 0x07);
+
+        switch(op & 0xF0)
+          {
+            case SEQ_SET:
+                OUTPUT_PORT |= mask;
+                s->used |= mask;
+                break;
+            case SEQ_CLR:
+                OUTPUT_PORT &= ~mask;
+                s->used |= mask;
+                break;
+            case SEQ_WAIT_N:
+                s->wait = op & 0x0F;
+                return;
+            case SEQ_WAIT:
+                s->pc++;
+                s->wait = arg;
+                return;
+            case SEQ_RANDOM:
+                s->pc++;
+                s->wait = arg ? (seq_random() % arg) + 1 : 0;
+                return;
+            case SEQ_JUMP:
+                s->pc = arg;
+                break;
+            case SEQ_LOOP:
+                s->pc++;
+                if (s->loop == 0) s->loop = (op & 0x0F) + 1;    // first pass: load
+                if (--s->loop) s->pc = arg;
+                break;
+            default:
+                if (op == SEQ_END) seq_running &= ~(1<<n);  // outputs stay
+                else               seq_stop(n);             // unknown opcode
+                seq_ended();
+                return;
+          }
+      }
+  }
+
+void run_sequence(void)
+  {
+    unsigned char n;
+
+    if (timerval == last_seq_run) return;
+    last_seq_run++;                             // one tick per call
+
+    for (n=0; n<SEQ_MAX; n++)
+      {
+        if (!(seq_running & (1<<n))) continue;
+        if (seq[n].wait > 1)
+          {
+            seq[n].wait--;
+            continue;
+          }
+        seq[n].wait = 0;
+        seq_step(n);
+      }
+  }
+
+#endif // (SEQUENCE_ENABLED == TRUE)
@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------
+//
+// OpenDCC - OpenDecoder2
+//
+// This source file is subject of the GNU general public license 2,
+// that is available at the world-wide-web at
+// http://www.gnu.org/licenses/gpl.txt
+//
+//------------------------------------------------------------------------
+//
+// file:      sequence.h
+// history:   2026-10-17 V0.1 start
+//
+//------------------------------------------------------------------------
+//
+// purpose:   light sequences from eeprom (mode 6), see sequence.c
+//
+// howto:     Step 1: write the program to CV449..CV512 (EE_sequence):
+//                    byte 0..3 start address of sequence 0..3
+//                    (0xFF: none), then the code
+//            Step 2: set CV33 (MODE) to 6, call init_sequence()
+//            Step 3: accessory commands to sequence_action():
+//                    command 2*n stops, 2*n+1 starts sequence n
+//            Step 4: call run_sequence() in the main loop
+//
+//------------------------------------------------------------------------
+#ifndef _SEQUENCE_H_
+#define _SEQUENCE_H_
+
+#define SEQUENCE_MODE   6           // CV.MODE of the sequencer
+#define SEQ_MAX         4           // sequences running at the same time
+#define SEQ_SIZE        64          // bytes of EE_sequence (start table + code)
+#define SEQ_NONE        0xFF        // start table: no sequence
+#define SEQ_STEPS       8           // max. instructions per tick and sequence
+
+#define SEQ_CV_FIRST    (449-1)     // EE_sequence[0] is CV449 (coded as 448)
+#define SEQ_CV_LAST     (SEQ_CV_FIRST + SEQ_SIZE - 1)
+
+// opcodes - n: low nibble, a: address in EE_sequence, t: ticks (20ms)
+#define SEQ_END         0x00        // 00       stop this sequence, outputs stay
+#define SEQ_SET         0x10        // 1n       output n on (n = 0..7)
+#define SEQ_CLR         0x20        // 2n       output n off
+#define SEQ_WAIT_N      0x30        // 3n       wait n ticks (1..15; 0: next tick)
+#define SEQ_WAIT        0x40        // 40 t     wait t ticks (0: next tick)
+#define SEQ_RANDOM      0x50        // 50 t     wait 1..t ticks, random
+#define SEQ_JUMP        0x60        // 60 a     continue at a
+#define SEQ_LOOP        0x70        // 7n a     continue at a, n times; then go on
+                                    //          (one loop counter per sequence)
+
+void init_sequence(void);
+
+void sequence_load(void);           // code changed (CV write)
+
+void sequence_action(unsigned int Command);
+
+void run_sequence(void);
+
+#endif // _SEQUENCE_H_
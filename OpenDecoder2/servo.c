@@ -38,6 +38,22 @@
 //            2008-09-26          extended Servo range
 //            2008-12-15 V0.13 kw bugfix in extended Servo range
 //            2012-02-12 V0.14    added SWITCH_4567
+//            2026-10-17          interpolation without division per tick:
+//                                segment setup, then an accumulator
+//            2026-10-17          SERVO_MUX: 8 servos on OUTPUT_PORT, pulses by timer0;
+//                                curves are read from flash/eeprom, not copied
+//            2026-10-17          SERVO_FRAME: pulses and positions every frame (5..20ms),
+//                                selected per servo by the Frame CV
+//            2026-10-17          SERVO_PLAN: curve 16 is a jerk limited move, planned
+//                                from CV596..598 (no curve table)
+//            2026-10-17          eeprom curves delta coded, with a directory:
+//                                16 user curves (1..4, 17..28), streamed
+//            2026-10-17          SERVO_MUX: MUX_LEAD 96, covers INT0 of the
+//                                edge receiver
+//            2026-10-17          SERVO_MUX: the ISR writes a precomputed edge
+//                                first and enables the interrupts; jitter stated
+//            2026-10-17          eeprom curves: a delta beyond time 255 ends the
+//                                curve (no wrap)
 //
 //------------------------------------------------------------------------
 //
@@ -56,6 +72,7 @@
 //
 // used:      Timer 1, OCR registers
 //            OUTPUT_PORT (all bits)
+//            with SERVO_MUX: Timer 0 and OUTPUT_PORT for the pulses, OCR1 not used
 //
 //------------------------------------------------------------------------
 
@@ -94,11 +111,11 @@
 #define TICK_PERIOD       20000L    // 20ms tick for Timing Engine
                                     // => possible values for timings up to
                                     //    5.1s (=255/0.020)
-                                    // note: this is also used as frame for
-                                    // Servo-Outputs (OCR1A and OCR1B)
+                                    // note: the frame for Servo-Outputs
+                                    // (OCR1A and OCR1B) is SERVO_FRAME, see config.h
 
 
-#define UPDATE_PERIOD     20000L    // 20ms -> 50Hz
+#define UPDATE_PERIOD     SERVO_FRAME   // 20ms -> 50Hz, 5ms -> 200Hz
 #define CTRL_PERIOD      100000L    // 0.1s resolution -> 25 sec max.
 
 // Timing Borders for Servo Pulse
@@ -139,6 +156,13 @@
 #define SWITCH_4567         TRUE // FALSE        // die Ausgnge 4567 werden bei manual adjust
                                         // als permanentes Paar mitgeschaltet
 
+#if (SERVO_MUX == TRUE)                 // all outputs are servo pulses
+    #undef  USE4567_FOR_ADJUST
+    #define USE4567_FOR_ADJUST   TRUE
+    #undef  SWITCH_4567
+    #define SWITCH_4567          FALSE
+#endif
+
 //------------------------------------------------------------------------------
 // internal, but static:
 enum servo_states
@@ -250,7 +274,11 @@ void my_output(unsigned char port_no, unsigned char state)
 //--------------------------------------------------------------------------------
 //
 
-#define NO_OF_SERVOS          2         // number of Servos 
+#if (SERVO_MUX == TRUE)
+#define NO_OF_SERVOS          8         // number of Servos, on OUTPUT_PORT
+#else
+#define NO_OF_SERVOS          2         // number of Servos, on OC1A and OC1B
+#endif
                                         
 #define SIZE_SERVO_CURVE      24         // number of entries (pairs) in one control
 
@@ -289,6 +317,8 @@ typedef struct    // curve, normalized [0..255]
 // 13 sig_hp0:   | close flag, after-whip          1  240     230   25   700ms
 // 14 sig_hp1:   | open flag, after-whip           1  240      25  230   700ms
 // 15 sig_hp1p:  | open flag, pause, after-whip    1  240      25  230  1280ms
+// 16 plan       | jerk limited move, A and B     25  230      25  230   (CV596..598)
+//               | (SERVO_PLAN, see plan_start)                230   25
 //
 
 const t_curve_point lin_A[] PROGMEM = 
@@ -562,21 +592,34 @@ const t_curve_point hp1p[] PROGMEM =
 
 // eeprom curves -> they are defined in config.c - reason is the
 // EEMEM handling of gcc
+//
+// EE_servo_curves (SV_CURVE_POOL = 192 bytes) holds up to SV_CURVES (16) user
+// curves, numbered 1..4 and 17..28 (user curve 5..16). The curves have no fixed
+// size, they are delta coded:
+//
+//   EE_servo_curves[0..15]:  directory, offset of user curve 1..16 in
+//                            EE_servo_curves; an offset below 16 or outside
+//                            the pool: no curve (-> lin_A, like an unknown number)
+//   curve:       start position (time 0), then the points:
+//     0tdddddd   time + t+1 (1..2), position + dddddd (-32..31)  SVC_STEP(dt, dpos)
+//     1ttttttt p time + ttttttt (1..127), position = p           SVC_JUMP(dt), p
+//     10000000   end of curve                                    SVC_END
+//
+// Times are summed up to the absolute time of a point (as in the flash curves,
+// a curve lasts up to 255 * time_ratio). A point needs 1 or 2 bytes instead
+// of 2, and short curves don't reserve space for 24 points.
+// The curves are read point by point during the move (read_curve_point).
 
-// this allocates 4 * 24 * 2 = 192 in EEPROM
-// t_curve_point ee_curve1[SIZE_SERVO_CURVE] EEMEM;
-// t_curve_point ee_curve2[SIZE_SERVO_CURVE] EEMEM;
-// t_curve_point ee_curve3[SIZE_SERVO_CURVE] EEMEM;
-// t_curve_point ee_curve4[SIZE_SERVO_CURVE] EEMEM;
+#define CURVE_EE_MORE    17         // curve_ean 17..28: user curves 5..16
 
 
 t_curve_point *pre_def_curves[] =
   {
     (t_curve_point *) move_A,                                 //  0: reserved
-    (t_curve_point *) EE_servo_curve1,      //  1: eeprom curve 1
-    (t_curve_point *) EE_servo_curve2,      //  2: eeprom curve 2
-    (t_curve_point *) EE_servo_curve3,      //  3: eeprom curve 3
-    (t_curve_point *) EE_servo_curve4,      //  4: eeprom curve 4
+    0,                                                        //  1: eeprom curve 1 (ee_curve)
+    0,                                                        //  2: eeprom curve 2
+    0,                                                        //  3: eeprom curve 3
+    0,                                                        //  4: eeprom curve 4
     (t_curve_point *) lin_A,                                  //  5: linear A
     (t_curve_point *) lin_B,                                  //  6: linear B
     (t_curve_point *) move_A,                                 //  7: move A
@@ -608,8 +651,8 @@ t_curve_point *pre_def_curves[] =
 #define MOVE2A           0
 #define MOVE2B           1
 
-t_curve_point servo1_curve[SIZE_SERVO_CURVE]; 
-t_curve_point servo2_curve[SIZE_SERVO_CURVE]; 
+#define CURVE_RAM        0xFF       // curve_ean of a curve calculated by calc_curve
+#define CURVE_PLAN       16         // curve_ean of a planned move (SERVO_PLAN)
 
 
 typedef struct
@@ -627,44 +670,255 @@ typedef struct
 
     unsigned char repeat;           // if REPEAT: this is the number of repeats to do
 
-    unsigned char curve_index;      // points to actual target in curve
+    unsigned char curve_index;      // points read from the curve, 1 = the start point
 
-    t_curve_point *curve;           // curve, normalized [0..255]
+    unsigned char curve_ean;        // 1..4, 17..28: eeprom curve, 5..15: flash curve
+    const unsigned char *curve;     // read pointer of the curve (normalized [0..255]),
+                                    // in eeprom, flash or ram: the next point
+    t_curve_point target;           // runtime: target point of this segment
       
     unsigned int active_time;       // runtime: relative time to start point
                                     // 0        = restart Servos
                                     // 0xffff   = finished
 
     unsigned char time_ratio;       // ratio between runtime and curve time
+
+    unsigned char frames;           // updates per timetick: 1 or SERVO_FRAMES (Frame CV)
+    unsigned char sub;              // runtime: frame within this timetick
+
+    unsigned int seg_end;           // runtime: active_time of the target point
+    int32_t acc;                    // runtime: pulse width in this segment, 16.16 fixed point
+    int32_t step;                   // increment of acc per update (frame)
+                                    // planned move: jerk, 2^-23 us per update^3
+  #if (SERVO_PLAN == TRUE)
+    int32_t vel;                    // planned move: velocity, 2^-23 us per update
+    int32_t accel;                  // planned move: acceleration, 2^-23 us per update^2
+    unsigned char n_jerk;           // planned move: updates of phase 1, 3, 5, 7 (jerk)
+    unsigned int n_accel;           // planned move: updates of phase 2, 6 (const. accel.)
+    unsigned int n_cruise;          // planned move: updates of phase 4 (const. velocity)
+  #endif
   } t_servo;
 
 
 
 t_servo servo[NO_OF_SERVOS] =
-  { { SERVO_MIN,
+  { [0 ... NO_OF_SERVOS-1] =
+    { SERVO_MIN,
       SERVO_DELTA,
           0,            // unsigned int min;  
       65000,            // unsigned int max; 
           0,            // unsigned char control;
           0,            // unsigned char repeat;
           1,            // unsigned char curve_index;
-      servo1_curve,     // pointer to curve
-          0,            // time
+          5,            // curve
+      (const unsigned char *) lin_A,
+      { 0, 0 },         // target
+     0xFFFF,            // time: finished
           1,            // ratio of curve
-    },
-    { SERVO_MIN,
-      SERVO_DELTA,
-       1000,            // unsigned int min;  
-      50000,            // unsigned int max; 
-        0,              // unsigned char control;
-        0,              // unsigned char repeat;
-        1,              // unsigned char curve_index;
-      servo2_curve,     // pointer to curve
-        0,              // time
-        1,              // ratio of curve
+          1,            // frames: pulse every 20ms
     },
   };
 
+//-----------------------------------------------------------------------------------
+// CVs of a servo: 12 CVs each, in the order of Sv1_minL ... Sv1_Frame;
+// servo 1 and 2 at CV551, servo 3..8 (SERVO_MUX) at CV600.
+//
+// SV_CV(nr, Mode) is the eeprom address of Sv<nr+1>_Mode.
+
+#define SV_CV_SIZE       (&CV.Sv2_minL - &CV.Sv1_minL)
+#define SV_CV(nr, name)  (servo_cv(nr) + (&CV.Sv1_##name - &CV.Sv1_minL))
+
+static unsigned char *servo_cv(unsigned char nr)
+  {
+    #if (SERVO_MUX == TRUE)
+        if (nr >= 2) return(&CV.Sv3_8[(nr - 2) * SV_CV_SIZE]);
+    #endif
+    return(&CV.Sv1_minL + nr * SV_CV_SIZE);
+  }
+
+//-----------------------------------------------------------------------------------
+// Servo frames
+//
+// Timer1 runs with a period of SERVO_FRAME (config.h): 20ms or a part of it (10ms,
+// 5ms); the timetick is every SERVO_FRAMES periods. A servo with Frame CV = 1 gets
+// a pulse and a new position in every frame - this gives a smoother move. Other
+// servos (analog servos may not accept a shorter frame) get a pulse only in the
+// first frame of a timetick and their position is calculated only then.
+//
+// set_servo_val stores the width; run_servo calls servo_frame_out once per frame.
+
+unsigned int servo_pulse[NO_OF_SERVOS];             // pulse width, 0 = no pulse
+
+// width of the pulse of servo nr in this frame; tick: first frame of a timetick
+static unsigned int frame_width(unsigned char nr, unsigned char tick)
+  {
+    if (tick || (servo[nr].frames > 1)) return(servo_pulse[nr]);
+    return(0);                                      // 20ms servo: no pulse in this frame
+  }
+
+#if (SERVO_MUX == TRUE)
+//-----------------------------------------------------------------------------------
+// Multiplexed pulses (SERVO_MUX)
+//
+// Servo nr gets its pulse on OUTPUT_PORT bit nr. The pulses follow each other:
+// the end of one pulse is the start of the next one, so all 8 fit into one frame
+// of 20ms (up to 2.5ms each).
+//
+// Timer1 cannot do this: it runs fast PWM with TOP = ICR1 for the 20ms tick and
+// its compare registers are double buffered (updated only at TOP), so a compare
+// can not be chained within one period. Timer0 runs with the prescaler of timer1,
+// one count is the same time unit as a pulse width (1us at 8MHz); it is free with
+// ALTERNATE_RECEIVE 2 and without RailCom and dimmer.
+//
+// TIMER0_COMP does all edges. The next match is set relative to the last one
+// (OCR0), so the pulse width does not add up latencies; a pulse is split into
+// steps:
+//   rest >= 256+MUX_LEAD:  OCR0 unchanged, next match after one turn of timer0
+//   rest > 255:            OCR0 += 128
+//   else:                  OCR0 += rest, this is the end of the pulse
+// The edge itself is written in software: an interrupt which blocks at the match
+// delays it. So the ISR writes the edge and the next OCR0 first, from values it
+// has computed at the match before (mux_edge, mux_out, mux_step), then masks the
+// timetick (TOIE1) and enables the interrupts; the values for the next match are
+// computed after that. Each edge is late by the blocking time at its match, the
+// edges of one pulse independently: INT0 blocks up to its sei() (~56 cycles),
+// the ACK timeout in TIMER1_OVF and the cli sections of main are shorter. A pulse
+// width jitters by up to ~7us (see tools/isr_budget.txt).
+// The shortest wait is MUX_LEAD counts (768 cycles): the computation must be done
+// before, even if INT0 (edge receiver, up to 370 cycles) interrupts it.
+//
+// A frame is started from run_servo (servo_frame_out), once per SERVO_FRAME; the
+// servos with a pulse are taken from servo_pulse (main) to mux_bits and mux_width
+// (ISR) only when no frame is running. All pulses of one frame must fit into
+// SERVO_FRAME, otherwise frames are skipped: 8 servos of 2.5ms need 20ms, with a
+// shorter frame only some of the servos should use it (Frame CV).
+
+#define MUX_LEAD     96             // shortest wait for a match [timer counts]
+
+#define MUX_NONE     0              // mux_edge: no edge at this match
+#define MUX_EDGE     1              //   write mux_out
+#define MUX_END      2              //   write mux_out (0), the frame is done
+
+static unsigned char mux_bits[NO_OF_SERVOS];        // outputs with a pulse in this frame
+static unsigned int mux_width[NO_OF_SERVOS];        //   and their widths
+static unsigned char mux_count;                     // entries in mux_bits, mux_width
+static volatile unsigned char mux_next;             // ISR: next entry
+static volatile unsigned int mux_rest;              // ISR: counts of the pulse after the next match
+static volatile unsigned char mux_edge;             // ISR: at the next match
+static volatile unsigned char mux_out;
+static volatile unsigned char mux_step;             //   OCR0 += mux_step (0: one turn)
+static unsigned char mux_on;                        // init_servo has started timer0
+
+// edge and step of the next match; the match just programmed ends the pulse if
+// there is no rest
+static inline void mux_prepare(void) __attribute__((always_inline));
+void mux_prepare(void)
+  {
+    unsigned int rest = mux_rest;
+
+    if (rest == 0)
+      {
+        // end of this pulse = start of the next one
+        if (mux_next >= mux_count)
+          {
+            mux_out = 0;
+            mux_edge = MUX_END;
+            return;
+          }
+        mux_out = mux_bits[mux_next];
+        rest = mux_width[mux_next];
+        mux_next++;
+        mux_edge = MUX_EDGE;
+      }
+    else mux_edge = MUX_NONE;
+
+    if (rest >= (256 + MUX_LEAD))
+      {
+        mux_step = 0;                               // OCR0 unchanged: one turn
+        rest -= 256;
+      }
+    else if (rest > 255)
+      {
+        mux_step = 128;
+        rest -= 128;
+      }
+    else
+      {
+        mux_step = rest;
+        rest = 0;
+      }
+    mux_rest = rest;
+  }
+
+ISR(TIMER0_COMP_vect)
+  {
+    unsigned char tick;
+
+    if (mux_edge != MUX_NONE)
+      {
+        OUTPUT_PORT = mux_out;                      // the edge first
+        if (mux_edge == MUX_END)
+          {
+            TIMSK &= ~(1<<OCIE0);                   // frame done
+            return;
+          }
+      }
+    OCR0 += mux_step;
+
+    tick = TIMSK & (1<<TOIE1);                      // no timetick within: it runs
+    TIMSK &= ~(1<<TOIE1);                           //   up to 0.5ms with sei
+    sei();                                          // INT0 may come in
+    mux_prepare();
+    cli();
+    TIMSK |= tick;
+  }
+
+static void servo_frame_out(unsigned char tick)
+  {
+    unsigned char i, n;
+    unsigned int width;
+
+    if (!mux_on) return;
+    if (TIMSK & (1<<OCIE0)) return;                 // last frame still running (too long)
+
+    n = 0;
+    for (i=0; i<NO_OF_SERVOS; i++)
+      {
+        width = frame_width(i, tick);
+        if (width < MUX_LEAD) continue;             // no pulse for this servo
+        mux_bits[n] = 1 << i;
+        mux_width[n] = width;
+        n++;
+      }
+    if (n == 0) return;
+
+    mux_count = n;
+    mux_next = 0;
+    mux_rest = 0;
+    mux_prepare();                                  // first match starts the first pulse
+    cli();
+    OCR0 = TCNT0 + MUX_LEAD;
+    TIFR = (1<<OCF0);                               // clear an old match
+    TIMSK |= (1<<OCIE0);
+    sei();
+  }
+
+static void init_servo_mux(void)
+  {
+    OUTPUT_PORT = 0;
+    TCCR0 = (0 << FOC0)         // Timer0: normal mode
+          | (0 << WGM00)        // wgm = 00: normal, top = 0xFF
+          | (0 << COM01)        // com = 00: pin operates as usual
+          | (0 << COM00)
+          | (0 << WGM01)
+          | (0 << CS02)         // cs = 010: clk/8 -> like timer1
+          | (1 << CS01)
+          | (0 << CS00);
+    mux_on = 1;
+  }
+
+#else  // (SERVO_MUX == TRUE)
+
 // Note on setting: if a zero is output to OCR, this will give small spike
 // Therefore we invert all:
 // clear output at TOP and set at OCR; writing a value equal to TOP will give a all zero output.
@@ -673,51 +927,355 @@ t_servo servo[NO_OF_SERVOS] =
 
 // see port_engine.c!
 #define T1_PRESCALER  8
-#define TOPVAL   (F_CPU / 1000000L * TICK_PERIOD / T1_PRESCALER) 
+#define TOPVAL   (F_CPU / 1000000L * SERVO_FRAME / T1_PRESCALER) 
 
-void set_servo_valA(unsigned int ocrval)
+// OCR1A/B are double buffered: the widths written in this frame are put out in the next one
+static void servo_frame_out(unsigned char tick)
   {
-    OCR1A = TOPVAL - ocrval;
+    OCR1A = TOPVAL - frame_width(0, tick);
+    OCR1B = TOPVAL - frame_width(1, tick);
   }
 
-void set_servo_valB(unsigned int ocrval)
+#endif // (SERVO_MUX == TRUE)
+
+void set_servo_val(unsigned char nr, unsigned int ocrval)
   {
-    OCR1B = TOPVAL - ocrval;
+    servo_pulse[nr] = ocrval;                       // put out by servo_frame_out
   }
 
+// Servo nr controls the outputs 2*nr (pre B) and 2*nr+1 (pre A), only servo 1 and 2
+// without SERVO_MUX (OUT_CTRL is never set otherwise)
 void set_relais_for_actual(unsigned char index)
   {
-    switch(index)
+    if (servo[index].control & (1<<SC_BIT_OUT_CTRL))
       {
-        case 0:
-            if (servo[0].control & (1<<SC_BIT_OUT_CTRL))
-              {
-                if (servo[0].control & (1<<SC_BIT_ACTUAL))  // we are pre B
-                  {
-                    my_output(PB0,1);                       // Output 0 on
-                  }
-                else
-                  {
-                    my_output(PB1,1);                       // Output 1 on
-                  }
-              }
-            break;
-        case 1:
-            if (servo[1].control & (1<<SC_BIT_OUT_CTRL))
-              {
-                if (servo[1].control & (1<<SC_BIT_ACTUAL))  // we are pre B
-                  {
-                    my_output(PB2,1);                       // Output 0 on
-                  }
-                else
-                  {
-                    my_output(PB3,1);                       // Output 1 on
-                  }
-              }
-            break;
+        if (servo[index].control & (1<<SC_BIT_ACTUAL))  // we are pre B
+          {
+            my_output(2*index, 1);                      // Output 0 (2) on
+          }
+        else
+          {
+            my_output(2*index+1, 1);                    // Output 1 (3) on
+          }
+      }
+  }
+
+//---------------------------------------------------------------------------------
+// eeprom curves
+//
+// ee_curve_nr: user curve (1..16) of a curve number, 0 = no eeprom curve
+static unsigned char ee_curve_nr(unsigned char curve_ean)
+  {
+    if ((curve_ean >= 1) && (curve_ean <= 4)) return(curve_ean);
+    if ((curve_ean >= CURVE_EE_MORE) && (curve_ean < CURVE_EE_MORE + SV_CURVES - 4))
+        return(curve_ean - CURVE_EE_MORE + 5);
+    return(0);
+  }
+
+// ee_curve: start of user curve (1..16) in EE_servo_curves, 0 = no such curve
+static const unsigned char *ee_curve(unsigned char user)
+  {
+    unsigned char offset;
+
+    offset = my_eeprom_read_byte(&EE_servo_curves[user-1]);
+    if ((offset < SV_CURVES) || (offset >= SV_CURVE_POOL)) return(0);
+    return(&EE_servo_curves[offset]);
+  }
+
+//---------------------------------------------------------------------------------
+// read_curve_point(unsigned char nr, t_curve_point *point)
+//      reads the next point of the curve of this servo, from eeprom, flash or ram,
+//      and advances the read pointer. The curves are not copied to ram; a point
+//      is read once per segment.
+//      The first point is the start point (time 0); after that, time = 0 is the
+//      end of the curve. The end is read again on every further call.
+//      eeprom curves are delta coded: time and position are relative to the
+//      last point read (servo[nr].target), they end at the end of the pool.
+//      A delta which would take the time beyond 255 ends the curve as well
+//      (t_curve_point.time is 8 bit; a wrapped time would never be reached).
+//      flash and ram curves are always terminated after SIZE_SERVO_CURVE-1 points.
+//
+static void read_curve_point(unsigned char nr, t_curve_point *point)
+  {
+    const unsigned char *src;
+    unsigned char code;
+
+    src = servo[nr].curve;
+    point->time = 0;                                    // end of list
+    point->position = 0;
+
+    if (ee_curve_nr(servo[nr].curve_ean))               // eeprom, delta coded
+      {
+        if (src >= &EE_servo_curves[SV_CURVE_POOL]) return;
+        code = my_eeprom_read_byte(src++);
+        if (servo[nr].curve_index == 0)
+          {
+            point->position = code;                     // start point
+          }
+        else if (code & 0x80)
+          {
+            code &= 0x7F;
+            if ((code == 0) || (src >= &EE_servo_curves[SV_CURVE_POOL])) return;
+            if (code > 255 - servo[nr].target.time) return;         // time would wrap
+            point->time = servo[nr].target.time + code;
+            point->position = my_eeprom_read_byte(src++);
+          }
+        else
+          {
+            if ((code >> 6) + 1 > 255 - servo[nr].target.time) return;  // time would wrap
+            point->time = servo[nr].target.time + (code >> 6) + 1;
+            point->position = servo[nr].target.position + ((signed char)(code << 2) >> 2);
+          }
+      }
+    else
+      {
+        if (servo[nr].curve_index >= (SIZE_SERVO_CURVE-1)) return;
+        #if (SEGMENT_ENABLED == TRUE)
+        if (servo[nr].curve_ean == CURVE_RAM)
+          {
+            point->time = src[0];
+            point->position = src[1];
+          }
+        else
+        #endif
+          {
+            point->time = pgm_read_byte(&src[0]);
+            point->position = pgm_read_byte(&src[1]);
+          }
+        src += 2;
+        if ((point->time == 0) && (servo[nr].curve_index != 0)) return;
+      }
+    servo[nr].curve = src;
+    servo[nr].curve_index++;
+  }
+
+//---------------------------------------------------------------------------------
+// calc_servo_segment(unsigned char nr, t_curve_point *prev)
+//      prepares the interpolation from curve point prev to servo[nr].target:
+//      both points are scaled to timer values (see calc_servo_single_val), the
+//      slope is divided once by the length of the segment.
+//      acc is set to the start point; it is valid at the time of this start point.
+//      seg_end is the active_time, when the target point is reached.
+//
+// Scaling:
+//      acc and step are 16.16 fixed point; a timer value is below TOPVAL (2^15),
+//      so the difference of two points fits into 32 bits.
+//
+unsigned int calc_servo_single_val(unsigned char nr, unsigned char position);
+
+static void calc_servo_segment(unsigned char nr, t_curve_point *prev)
+  {
+    int16_t start, delta_t;
+    int32_t delta_pos;
+
+    start = calc_servo_single_val(nr, prev->position);
+    delta_pos = (int32_t)calc_servo_single_val(nr, servo[nr].target.position) - start;
+
+    servo[nr].seg_end = servo[nr].target.time * servo[nr].time_ratio;
+    delta_t = (int)(servo[nr].target.time - prev->time) *  servo[nr].time_ratio;
+    if (delta_t <= 0) delta_t = 1;                                     // avoid div0, this is dirty
+
+    servo[nr].acc = (int32_t)start << 16;
+    servo[nr].step = (delta_pos << 16) / ((int32_t)delta_t * servo[nr].frames);
+  }
+
+// next_segment: the target is the new start point, the next point of the curve
+// the new target; FALSE at the end of the curve (nothing changed)
+static unsigned char next_segment(unsigned char nr)
+  {
+    t_curve_point prev, next;
+
+    read_curve_point(nr, &next);
+    if (next.time == 0) return(FALSE);
+    prev = servo[nr].target;
+    servo[nr].target = next;
+    calc_servo_segment(nr, &prev);                  // acc = prev
+    return(TRUE);
+  }
+
+#if (SERVO_PLAN == TRUE)
+//---------------------------------------------------------------------------------
+// Planned moves (curve 16)
+//      Instead of a curve table, the move from 25 to 230 (A) or 230 to 25 (B) is
+//      calculated as a jerk limited S-curve with seven phases:
+//
+//      phase   1      2      3      4       5      6      7
+//      jerk    +j     0      -j     0       -j     0      +j
+//      length  n1     n2     n1     n3      n1     n2     n1
+//
+//      v, a and j are limited by CV596..598 (for all servos); the time stretch
+//      TimeA / TimeB of the servo divides the velocity.
+//      plan_start chooses n1, n2, n3 within these limits and then scales j, so
+//      that the sum of all steps is exactly the distance; per update only some
+//      additions are done (plan_next), no multiplication or division.
+//
+//      Units: position (acc) is 16.16 fixed point; jerk (step), accel and vel
+//      are in 2^-23 us per update, acc gets vel >> 7.
+//      curve_index is the phase, seg_end the updates left in this phase.
+
+#define PLAN_LOW   25               // endpoints of the planned move, scaled like
+#define PLAN_HIGH  230              // a curve point (calc_servo_single_val)
+
+static unsigned int plan_target(unsigned char nr)
+  {
+    if (servo[nr].control & (1<<SC_BIT_ACTUAL))
+        return(calc_servo_single_val(nr, PLAN_LOW));        // move B
+    else
+        return(calc_servo_single_val(nr, PLAN_HIGH));       // move A
+  }
+
+static uint32_t plan_cv(unsigned char *cv)
+  {
+    unsigned char val;
+
+    val = my_eeprom_read_byte(cv);
+    if (val == 0) val = 1;
+    return(val);
+  }
+
+// distance of a move with n1, n2 and no cruise (n3 = 0), in units of the jerk;
+// each update of phase 4 adds n1 * (n1 + n2).
+// n1 <= 255, n2 <= 1023: fits into 32 bits.
+static uint32_t plan_dist(uint32_t n1, uint32_t n2)
+  {
+    uint32_t u1, s;
+
+    u1 = n1 * (n1 + 1) / 2;
+    s = n2 * u1                                 // phase 1, 2 and 3: ramp up
+      + n1 * (n2 * (n2 + 1) / 2)
+      + n1 * (u1 + n1 * n2)
+      + n1 * n1 * (n1 + 1) / 2;
+    return(2 * s - n1 * (n1 + n2));             // phase 5..7: the same, one step earlier
+  }
+
+// next phase with updates left; TRUE, if the move is done
+static unsigned char plan_phase(unsigned char nr)
+  {
+    while (servo[nr].seg_end == 0)
+      {
+        servo[nr].curve_index++;
+        if (servo[nr].curve_index > 7) return(TRUE);
+        if (servo[nr].curve_index == 4) servo[nr].seg_end = servo[nr].n_cruise;
+        else if (servo[nr].curve_index & 1) servo[nr].seg_end = servo[nr].n_jerk;
+        else servo[nr].seg_end = servo[nr].n_accel;
+      }
+    return(FALSE);
+  }
+
+static void plan_start(unsigned char nr)
+  {
+    unsigned int start, target;
+    uint32_t f, v, a, j, dist, dj, w, q, r;
+    uint32_t n1, n2, n3, lo, hi, m;
+    unsigned char i;
+
+    start = calc_servo_single_val(nr, (servo[nr].control & (1<<SC_BIT_ACTUAL)) ? PLAN_HIGH : PLAN_LOW);
+    target = plan_target(nr);
+
+    // limits per update
+    f = servo[nr].frames;
+    m = servo[nr].time_ratio;
+    if (m == 0) m = 1;
+    v = (plan_cv(&CV.Sv_Vmax) << 23) / f / m;
+    a = (plan_cv(&CV.Sv_Amax) << 19) / (f * f);
+    j = (plan_cv(&CV.Sv_Jmax) << 17) / (f * f * f);
+    if (j > a) j = a;
+    if (j > v) j = v;
+
+    if (target >= start) dist = target - start;
+    else dist = start - target;
+    dj = (dist << 16) / (j >> 7) + 1;           // distance in units of the max. jerk
+
+    // longest phases within the limits: a = n1 * j, v = n1 * (n1 + n2) * j
+    n1 = a / j;
+    if (n1 > 255) n1 = 255;
+    while (n1 * n1 > v / j) n1--;
+    n2 = v / j / n1 - n1;
+    if (n2 > 1023) n2 = 1023;
+
+    // short move: max. velocity (or acceleration) is not reached
+    if (plan_dist(n1, 0) >= dj)
+      {
+        lo = 1; hi = n1;
+        while (hi - lo > 1)
+          {
+            m = (lo + hi) / 2;
+            if (plan_dist(m, 0) < dj) lo = m;
+            else hi = m;
+          }
+        n1 = lo;
+        n2 = 0;
+      }
+    else if (plan_dist(n1, n2) >= dj)
+      {
+        lo = 0; hi = n2;
+        while (hi - lo > 1)
+          {
+            m = (lo + hi) / 2;
+            if (plan_dist(n1, m) < dj) lo = m;
+            else hi = m;
+          }
+        n2 = lo;
+      }
+
+    // cruise for the rest
+    f = plan_dist(n1, n2);
+    w = n1 * (n1 + n2);
+    n3 = 0;
+    if (f < dj) n3 = (dj - f + w - 1) / w;
+    if (n3 > 0xFFFF) n3 = 0xFFFF;
+    f += n3 * w;
+
+    // scale the jerk: j = (dist << 23) / f
+    q = (dist << 16) / f;
+    r = (dist << 16) % f;
+    for (i=0; i<7; i++)
+      {
+        q <<= 1; r <<= 1;
+        if (r >= f) { r -= f; q++; }
       }
+    if (dist == 0) n1 = n2 = n3 = 0;
+
+    servo[nr].step = (target >= start) ? (int32_t)q : -(int32_t)q;
+    servo[nr].n_jerk = n1;
+    servo[nr].n_accel = n2;
+    servo[nr].n_cruise = n3;
+    servo[nr].vel = 0;
+    servo[nr].accel = 0;
+    servo[nr].acc = (int32_t)start << 16;
+    servo[nr].curve_index = 0;
+    servo[nr].seg_end = 0;
+    plan_phase(nr);                             // phase 1 (or done, if dist == 0)
   }
 
+// one update of the planned move; TRUE, if the target is reached (acc is then
+// exactly the target)
+static unsigned char plan_next(unsigned char nr)
+  {
+    if (servo[nr].curve_index <= 7)
+      {
+        switch(servo[nr].curve_index)
+          {
+            case 1: servo[nr].accel += servo[nr].step; break;
+            case 3: servo[nr].accel -= servo[nr].step; break;
+          }
+        servo[nr].vel += servo[nr].accel;
+        switch(servo[nr].curve_index)
+          {
+            case 5: servo[nr].accel -= servo[nr].step; break;
+            case 7: servo[nr].accel += servo[nr].step; break;
+          }
+        servo[nr].acc += servo[nr].vel >> 7;
+        servo[nr].seg_end--;
+        if (!plan_phase(nr)) return(FALSE);
+      }
+    servo[nr].acc = (int32_t)plan_target(nr) << 16;
+    return(TRUE);
+  }
+#endif
+
+static void servo_end_of_move(unsigned char nr);
+
 //---------------------------------------------------------------------------------
 // calc_servo_next_val(unsigned char nr)
 //      generates the actual setting of OCR out of actual position.
@@ -727,7 +1285,17 @@ void set_relais_for_actual(unsigned char index)
 //         limits.
 //      c) transforms the point to real servo position
 //
-//      This routine is to be called every timeslot (20ms).
+//      a) to c) are done once per curve point by calc_servo_segment; per update
+//      only the step is added (no multiplication or division). When a curve point
+//      is reached, its exact value is taken, so the rounding of step does not add up.
+//
+//      This routine is to be called every timeslot (20ms), or every frame if this
+//      servo has frames > 1; the step is then a part of the step per timeslot.
+//      Curve points are at full timeslots - the cost per frame stays one addition,
+//      a segment setup is done at most once per timeslot.
+//
+//      A planned move (curve 16) has no curve points: every call is one update
+//      of plan_next.
 //      
 // Parameters:
 //      nr: this servo is calculated
@@ -735,11 +1303,6 @@ void set_relais_for_actual(unsigned char index)
 // Return:
 //      timer value (OCR1) of this servo; if retval = 0, movement is finished
 //
-// Scaling:
-//      input positions (from curve table) are 8 bit;
-//      intermediate interpolations are scaled up to 32 bits; headroom for signed types is reserved.
-//      this scaling is neccesary to achieve a good resolution when moving;
-//
 
 #if (SIMULATION != 0)
 volatile int16_t simint;  volatile int32_t simlong;
@@ -747,175 +1310,139 @@ volatile int16_t simint;  volatile int32_t simlong;
 
 unsigned int calc_servo_next_val(unsigned char nr)
   {
-    unsigned char myindex;        // index in curve
     int16_t posi;
-    int16_t dt, delta_t;          // time delta always > 0
-    int32_t posl;
-    int16_t delta_pos;
     unsigned char end_of_list_reached = 0;
 
     if (servo[nr].active_time == 0xFFFF) return(0);    // inactive - do nothing
 
+    #if (SERVO_PLAN == TRUE)
+    if (servo[nr].curve_ean == CURVE_PLAN)
+      {
+        if (servo[nr].active_time == 0)
+          {
+            plan_start(nr);                             // just started
+            servo[nr].active_time = 1;
+          }
+        end_of_list_reached = plan_next(nr);
+        posi = (servo[nr].acc + 0x8000L) >> 16;
+        if (end_of_list_reached) servo_end_of_move(nr);
+        return(posi);
+      }
+    #endif
+
+    if ((servo[nr].active_time == 0) && (servo[nr].sub == 0))
+      {
+        // just started: read the start point, then the first segment
+        read_curve_point(nr, &servo[nr].target);
+        if (!next_segment(nr))
+          {
+            // only a start point - stay there
+            servo[nr].acc = (int32_t)calc_servo_single_val(nr, servo[nr].target.position) << 16;
+            servo[nr].step = 0;
+            servo[nr].seg_end = 1;
+          }
+      }
+
+    if (++servo[nr].sub < servo[nr].frames)
+      {
+        // frame within a timeslot, no curve point here
+        servo[nr].acc += servo[nr].step;
+        return((servo[nr].acc + 0x8000L) >> 16);
+      }
+    servo[nr].sub = 0;
+
     servo[nr].active_time++;
     
     // check, if next curve point is reached
-    myindex = servo[nr].curve_index;
-    
-    if ((servo[nr].curve[myindex].time * servo[nr].time_ratio) == servo[nr].active_time)
+    if (servo[nr].seg_end == servo[nr].active_time)
       {
-        myindex++;
         // new curve point reached, how to proceed?
-        if (servo[nr].curve[myindex].time == 0)
+        if (!next_segment(nr))                      // acc = this point
           {
-            // end of list
+            // end of list - stay on last curve point
             end_of_list_reached = 1;
-            myindex--;                    // stay on last curve point             
+            servo[nr].acc = (int32_t)calc_servo_single_val(nr, servo[nr].target.position) << 16;
           }
-        else
-          {
-            servo[nr].curve_index = myindex;        // save index
-          } 
+      }
+    else
+      {
+        // linear interpolation: pos = pos_prev + dt * (pos - pos_prev) / delta_t
+        servo[nr].acc += servo[nr].step;
       }
 
-    // now calc linear interpolation
-    // pos = pos_prev + (dt / delta_t) * (pos - pos_prev)
-
-    dt = servo[nr].active_time - (int)servo[nr].curve[myindex-1].time * servo[nr].time_ratio;   // int
+    posi = (servo[nr].acc + 0x8000L) >> 16;                // round to timer value
 
-    delta_t = (int)(servo[nr].curve[myindex].time - servo[nr].curve[myindex-1].time)         // int
-              *  servo[nr].time_ratio;
+    if (end_of_list_reached == 1) servo_end_of_move(nr);
+    return(posi);
+  }
 
-    if (delta_t == 0) delta_t = 1;                                     // avoid div0, this is dirty
 
-    delta_pos = ((int)servo[nr].curve[myindex].position
-                 - (int)servo[nr].curve[myindex-1].position)   
-                * 128L;                                                 // int (with gain 128)
-                                                                        // range -32640 ... 32640
-    posl = (int32_t)delta_pos * dt;
+// end of a move: decide further processing (terminate, repeat)
+static void servo_end_of_move(unsigned char nr)
+  {
+    if (servo[nr].control & (1<<SC_BIT_ACTUAL))
+      {                                                 // we did movement "B"
         
-    posl = posl / delta_t;                                              // interpolated value
-    posl = posl + (int)servo[nr].curve[myindex-1].position * 128L;      // +offset (gain 128)
-                                                                        // range 0 ... 32640
-    // now correct for 255 as full scale of curve
-
-    posl = posl * 256L;
-    posl = posl / 255L;                                                 // range 0 ... 32768 (2^15)
-
-    // scale this position according to min/max
-    // scaled = min + interpolated * (max-min)
-
-    delta_pos = (int)(servo[nr].max / 4) - (int)(servo[nr].min / 4);    // range -16384 ... 16384 (2^14)
-
-    posl = posl * delta_pos;                                            // range -2^29 ... 2^29
-
-    posl = posl + (servo[nr].min * (8192L));                            // gain: 13 Bits => range 2^29
-
-    posl = posl / (16384L);                                              
-
-    // now scale to timer
-
-    posi = (int16_t) posl;                                  // range 0 ... 32767
-    posl = (int32_t) posi * servo[nr].pulse_delta;          // range 0 ... 32767000
-    posi = posl >> 15;                                      // range 0 ... 1000  
-    posi = posi + servo[nr].pulse_min;                      //      + SERVO_MIN;  // add 1ms
-
-    if (end_of_list_reached == 1)
-      {
-        // now decide further processing
-
-        if (servo[nr].control & (1<<SC_BIT_ACTUAL))
-          {                                                 // we did movement "B"
-            
-            servo[nr].control &= ~(1<<SC_BIT_ACTUAL);       // now we are pre A
-            if (servo[nr].control & (1<<SC_BIT_REPEAT))
-              {
-                // repeatmode -> go to A (if no terminate is requested)
-                if (servo[nr].control & (1<<SC_BIT_TERMINATE))
-                  {
-                    // terminate flag detected - stop now
-                    servo[nr].control &= ~(1<<SC_BIT_TERMINATE);
-                    servo[nr].control &= ~(1<<SC_BIT_MOVING);
-                    servo[nr].active_time = 0xFFFF;         // terminate
-                  }
-                else
-                  {
-                    if (servo[nr].repeat)
-                      {
-                        servo[nr].repeat--;
-                        if (servo[nr].repeat == 0)
-                          { // all repeats done, stop now
-                            servo[nr].control &= ~(1<<SC_BIT_TERMINATE);
-                            servo[nr].control &= ~(1<<SC_BIT_MOVING);
-                            servo[nr].active_time = 0xFFFF;
-                          }
-                        else
-                          {
-                            do_servo(nr, MOVE2A);               // goto A;
-                          }
-                      }
-                    else
-                      {
-                        do_servo(nr, MOVE2A);                   // goto A;
-                      }
-                  }
-              }
-            else
+        servo[nr].control &= ~(1<<SC_BIT_ACTUAL);       // now we are pre A
+        if (servo[nr].control & (1<<SC_BIT_REPEAT))
+          {
+            // repeatmode -> go to A (if no terminate is requested)
+            if (servo[nr].control & (1<<SC_BIT_TERMINATE))
               {
+                // terminate flag detected - stop now
+                servo[nr].control &= ~(1<<SC_BIT_TERMINATE);
                 servo[nr].control &= ~(1<<SC_BIT_MOVING);
-                servo[nr].active_time = 0xFFFF;             // terminate 
-                // now save position (0=pre A)
-                if (nr == 0) 
-                  {
-                    my_eeprom_write_byte(&CV.Sv1_Loc, 0);
-                    if (servo[nr].control & (1<<SC_BIT_OUT_CTRL))
-                      {
-                        my_output(PB1,1);                       // Output 1 on
-                      }
-                  }
-                if (nr == 1)
-                  {
-                    my_eeprom_write_byte(&CV.Sv2_Loc, 0);
-                    if (servo[nr].control & (1<<SC_BIT_OUT_CTRL))
-                      {
-                        my_output(PB3,1);                       // Output 3 on
-                      }
-                 }
-              }
-          }
-        else
-          {                                                 // we did movement "A"
-            servo[nr].control |= (1<<SC_BIT_ACTUAL);        // now we are pre B
-            
-            if (servo[nr].control & (1<<SC_BIT_REPEAT))
-              {
-                // repeatmode -> go to B
-                do_servo(nr, MOVE2B);
+                servo[nr].active_time = 0xFFFF;         // terminate
               }
             else
               {
-                servo[nr].control &= ~(1<<SC_BIT_MOVING);   // stopped
-                servo[nr].active_time = 0xFFFF;             // terminate
-                // save position (1= pre B)
-                if (nr == 0) 
+                if (servo[nr].repeat)
                   {
-                    my_eeprom_write_byte(&CV.Sv1_Loc, 1);
-                    if (servo[nr].control & (1<<SC_BIT_OUT_CTRL))
+                    servo[nr].repeat--;
+                    if (servo[nr].repeat == 0)
+                      { // all repeats done, stop now
+                        servo[nr].control &= ~(1<<SC_BIT_TERMINATE);
+                        servo[nr].control &= ~(1<<SC_BIT_MOVING);
+                        servo[nr].active_time = 0xFFFF;
+                      }
+                    else
                       {
-                        my_output(PB0,1);                       // Output 0 on
+                        do_servo(nr, MOVE2A);               // goto A;
                       }
                   }
-                if (nr == 1)
+                else
                   {
-                    my_eeprom_write_byte(&CV.Sv2_Loc, 1);
-                    if (servo[nr].control & (1<<SC_BIT_OUT_CTRL))
-                      {
-                        my_output(PB2,1);                       // Output 2 on
-                      }
+                    do_servo(nr, MOVE2A);                   // goto A;
                   }
               }
-          }         
-      }              
-    return(posi);
+          }
+        else
+          {
+            servo[nr].control &= ~(1<<SC_BIT_MOVING);
+            servo[nr].active_time = 0xFFFF;             // terminate 
+            // now save position (0=pre A)
+            my_eeprom_write_byte(SV_CV(nr, Loc), 0);
+            set_relais_for_actual(nr);                  // Output 1 (3) on
+          }
+      }
+    else
+      {                                                 // we did movement "A"
+        servo[nr].control |= (1<<SC_BIT_ACTUAL);        // now we are pre B
+        
+        if (servo[nr].control & (1<<SC_BIT_REPEAT))
+          {
+            // repeatmode -> go to B
+            do_servo(nr, MOVE2B);
+          }
+        else
+          {
+            servo[nr].control &= ~(1<<SC_BIT_MOVING);   // stopped
+            servo[nr].active_time = 0xFFFF;             // terminate
+            // save position (1= pre B)
+            my_eeprom_write_byte(SV_CV(nr, Loc), 1);
+            set_relais_for_actual(nr);                  // Output 0 (2) on
+          }
+      }         
   }
 
 
@@ -935,6 +1462,11 @@ unsigned int calc_servo_next_val(unsigned char nr)
 // Return:
 //      timer value (OCR1) of this servo; if retval = 0, movement is finished
 //
+// Scaling:
+//      input positions (from curve table) are 8 bit;
+//      intermediate values are scaled up to 32 bits; headroom for signed types is reserved.
+//      this scaling is neccesary to achieve a good resolution when moving;
+//
 
 
 unsigned int calc_servo_single_val(unsigned char nr, unsigned char position)
@@ -974,40 +1506,22 @@ unsigned int calc_servo_single_val(unsigned char nr, unsigned char position)
   }
 
 
-unsigned char read_curve_start(my_curve_ean)
+unsigned char read_curve_start(unsigned char my_curve_ean)
   {
-    t_curve_point *src;
-    unsigned char i = 0;
+    const unsigned char *src;
+    unsigned char user;
 
+    user = ee_curve_nr(my_curve_ean);
+    if (user)
+      {
+        src = ee_curve(user);
+        if (src) return(my_eeprom_read_byte(src));  // eeprom: start position first
+        my_curve_ean = 5;  // no such curve: default
+      }
     if (my_curve_ean >= (sizeof(pre_def_curves)/sizeof(pre_def_curves[0])))
         my_curve_ean = 5;  // default
 
-    src = pre_def_curves[my_curve_ean];
-
-    switch(my_curve_ean)
-      {
-        case 0: // reserved
-        case 1: // eeprom
-        case 2: // eeprom
-        case 3: // eeprom
-        case 4: // eeprom
-            i = my_eeprom_read_byte(&src->position); 
-            break;
-        case 5: // programm 
-        case 6:
-        case 7:
-        case 8:
-        case 9:
-        case 10:
-        case 11:
-        case 12:
-        case 13:
-        case 14:
-        case 15:           
-            i = pgm_read_byte(&src->position);
-            break;
-      }
-    return(i);
+    return(pgm_read_byte(&pre_def_curves[my_curve_ean]->position));
   }
 
 
@@ -1020,79 +1534,54 @@ void move_servo_to_start(unsigned char index)
   {
     unsigned char my_curve_ean;
     unsigned char start;
-    switch(index)
+
+    if (index >= NO_OF_SERVOS) return;
+
+    if (servo[index].control & (1<<SC_BIT_ACTUAL)) // pre B 
       {
-        case 0:
-            if (servo[0].control & (1<<SC_BIT_ACTUAL)) // pre B 
-              {
-                my_curve_ean = my_eeprom_read_byte(&CV.Sv1_CurveB) & 0x7F;
-              }
-            else
-              {
-                my_curve_ean = my_eeprom_read_byte(&CV.Sv1_CurveA) & 0x7F;
-              }
-    
-            start = read_curve_start(my_curve_ean);
-            #if (SIMULATION != 0)
-                T1 = start;
-                T1 = calc_servo_single_val(0, start);
-            #endif
-            set_servo_valA(calc_servo_single_val(0, start));
-            break;
-        case 1:
-            if (servo[1].control & (1<<SC_BIT_ACTUAL)) // pre B 
-              {
-                my_curve_ean = my_eeprom_read_byte(&CV.Sv2_CurveB) & 0x7F;
-              }
-            else
-              {
-                my_curve_ean = my_eeprom_read_byte(&CV.Sv2_CurveA) & 0x7F;
-              }
-    
-            start = read_curve_start(my_curve_ean);
-            #if (SIMULATION != 0)
-                T2 = start;
-                T2 = calc_servo_single_val(1, start);
-            #endif
-            set_servo_valB(calc_servo_single_val(1, start));
-            break;
-        default:
-            break;
+        my_curve_ean = my_eeprom_read_byte(SV_CV(index, CurveB)) & 0x7F;
+      }
+    else
+      {
+        my_curve_ean = my_eeprom_read_byte(SV_CV(index, CurveA)) & 0x7F;
       }
+
+    start = read_curve_start(my_curve_ean);
+    #if (SERVO_PLAN == TRUE)
+    if (my_curve_ean == CURVE_PLAN)
+        start = (servo[index].control & (1<<SC_BIT_ACTUAL)) ? PLAN_HIGH : PLAN_LOW;
+    #endif
+    #if (SIMULATION != 0)
+        if (index == 0) T1 = calc_servo_single_val(0, start);
+        if (index == 1) T2 = calc_servo_single_val(1, start);
+    #endif
+    set_servo_val(index, calc_servo_single_val(index, start));
   }
 
 
 void load_min_max(void)
   {
     unsigned char control;
+    unsigned char nr;
 
-    control = my_eeprom_read_byte(&CV.Sv1_Mode);
-    if (control & (1 << CVbit_SvMode_Stretch))
-      {
-        servo[0].pulse_delta = SERVO_DELTA * 2;
-        servo[0].pulse_min = SERVO_MIN / 2;
-      }
-    else
-      {
-        servo[0].pulse_delta = SERVO_DELTA;
-        servo[0].pulse_min = SERVO_MIN;
-      }
-    servo[0].min = my_eeprom_read_byte(&CV.Sv1_minL) + 256 * my_eeprom_read_byte(&CV.Sv1_min);
-    servo[0].max = my_eeprom_read_byte(&CV.Sv1_maxL) + 256 * my_eeprom_read_byte(&CV.Sv1_max);
-
-    control = my_eeprom_read_byte(&CV.Sv2_Mode);
-    if (control & (1 << CVbit_SvMode_Stretch))
+    for (nr=0; nr<NO_OF_SERVOS; nr++)
       {
-        servo[1].pulse_delta = SERVO_DELTA * 2;
-        servo[1].pulse_min = SERVO_MIN / 2;
-      }
-    else
-      {
-        servo[1].pulse_delta = SERVO_DELTA;
-        servo[1].pulse_min = SERVO_MIN;
+        control = my_eeprom_read_byte(SV_CV(nr, Mode));
+        if (control & (1 << CVbit_SvMode_Stretch))
+          {
+            servo[nr].pulse_delta = SERVO_DELTA * 2;
+            servo[nr].pulse_min = SERVO_MIN / 2;
+          }
+        else
+          {
+            servo[nr].pulse_delta = SERVO_DELTA;
+            servo[nr].pulse_min = SERVO_MIN;
+          }
+        servo[nr].min = my_eeprom_read_byte(SV_CV(nr, minL)) + 256 * my_eeprom_read_byte(SV_CV(nr, min));
+        servo[nr].max = my_eeprom_read_byte(SV_CV(nr, maxL)) + 256 * my_eeprom_read_byte(SV_CV(nr, max));
+        if (my_eeprom_read_byte(SV_CV(nr, Frame))) servo[nr].frames = SERVO_FRAMES;
+        else                                       servo[nr].frames = 1;
       }
-    servo[1].min = my_eeprom_read_byte(&CV.Sv2_minL) + 256 * my_eeprom_read_byte(&CV.Sv2_min);
-    servo[1].max = my_eeprom_read_byte(&CV.Sv2_maxL) + 256 * my_eeprom_read_byte(&CV.Sv2_max);
   }
 
 
@@ -1100,75 +1589,59 @@ void init_servo(void)
   {
     unsigned char location;
     unsigned char control;
+    unsigned char nr;
 
     servo_state = IDLE;
     load_min_max();
 
-    // try to find out actual position of Servo 1
-
-    location = my_eeprom_read_byte(&CV.Sv1_Loc);
-
-    if (location == 0)
-      {
-        servo[0].control &= ~(1<<SC_BIT_ACTUAL);                   // pre A 
-      }
-    else
-      {
-        servo[0].control |= (1<<SC_BIT_ACTUAL);                    // pre B 
-      } 
-
-    control = my_eeprom_read_byte(&CV.Sv1_Mode);
-    if (control & (1 << CVbit_SvMode_OUT_CTRL))
-      {
-        servo[0].control |= (1<<SC_BIT_OUT_CTRL);        // set flag for output control
-      }
-    else
+    for (nr=0; nr<NO_OF_SERVOS; nr++)
       {
-        servo[0].control &= ~(1<<SC_BIT_OUT_CTRL);       // set flag for output control
-      } 
-
-    set_relais_for_actual(0); 
-    move_servo_to_start(0);
+        // try to find out actual position of this servo
 
-    // try to find out actual position of Servo 2
+        location = my_eeprom_read_byte(SV_CV(nr, Loc));
 
-    location = my_eeprom_read_byte(&CV.Sv2_Loc);
+        if (location == 0)
+          {
+            servo[nr].control &= ~(1<<SC_BIT_ACTUAL);                   // pre A 
+          }
+        else
+          {
+            servo[nr].control |= (1<<SC_BIT_ACTUAL);                    // pre B 
+          } 
 
-    if (location == 0)
-      {
-        servo[1].control &= ~(1<<SC_BIT_ACTUAL);                   // pre A 
-      }
-    else
-      {
-        servo[1].control |= (1<<SC_BIT_ACTUAL);                    // pre B 
-      } 
+        control = my_eeprom_read_byte(SV_CV(nr, Mode));
+        if ((control & (1 << CVbit_SvMode_OUT_CTRL)) && (SERVO_MUX == FALSE))
+          {
+            servo[nr].control |= (1<<SC_BIT_OUT_CTRL);        // set flag for output control
+          }
+        else
+          {
+            servo[nr].control &= ~(1<<SC_BIT_OUT_CTRL);       // set flag for output control
+          } 
 
-    control = my_eeprom_read_byte(&CV.Sv2_Mode);
-    if (control & (1 << CVbit_SvMode_OUT_CTRL))
-      {
-        servo[1].control |= (1<<SC_BIT_OUT_CTRL);        // set flag for output control
+        set_relais_for_actual(nr); 
+        move_servo_to_start(nr);
       }
-    else
-      {
-        servo[1].control &= ~(1<<SC_BIT_OUT_CTRL);       // set flag for output control
-      } 
 
-    set_relais_for_actual(1); 
-    move_servo_to_start(1);
+    #if (SERVO_MUX == TRUE)
+        init_servo_mux();                   // pulses start with run_servo
+    #else
+        // now enable these OCR outputs
+        // OC1A and OC1B are mapped to Timer (for Servo Operation)
 
-    // now enable these OCR outputs
-    // OC1A and OC1B are mapped to Timer (for Servo Operation)
+        servo_frame_out(1);                 // first pulses, before the outputs are on
 
-    // busy waiting for a good moment to turn servo on
+        // busy waiting for a good moment to turn servo on
     
-    signed char my_timerval;
-    my_timerval = timerval;
-    while (my_timerval == timerval); 
-
-    TCCR1A |= (1 << COM1A1)          // compare match A
-            | (1 << COM1A0)          // set OC1A/OC1B on Compare Match, clear OC1A/OC1B at TOP
-            | (1 << COM1B1)          // compare match B
-            | (1 << COM1B0);
+        signed char my_timerval;
+        my_timerval = timerval;
+        while (my_timerval == timerval) HOST_WAIT(); 
+
+        TCCR1A |= (1 << COM1A1)          // compare match A
+                | (1 << COM1A0)          // set OC1A/OC1B on Compare Match, clear OC1A/OC1B at TOP
+                | (1 << COM1B1)          // compare match B
+                | (1 << COM1B0);
+    #endif
 
     #if (SERVO_POWER_UP == SPU_SOFT_PWM)
         // use a software pwm to ramp up servo power supply very slowly, to avoid unintended moves
@@ -1266,6 +1739,8 @@ void init_servo(void)
 //=================================================================================
 
 signed char last_servo_run;   // timer variable to create a update grid;
+static unsigned char last_servo_frame;          // frameval of the last run
+static signed char last_servo_tick;             // timerval of the last run
 
 #if (FLASH_DURING_MOVE == TRUE)
  unsigned char flash = 0;
@@ -1278,7 +1753,15 @@ void run_servo(void)
   {
     unsigned char i;
     unsigned int ocrval;
+    unsigned char tick;                     // first frame of a timetick
     
+    #if (SIMULATION == 0)
+        if (frameval == last_servo_frame) return;       // once per frame
+    #endif
+    last_servo_frame = frameval;
+    tick = (timerval != last_servo_tick);
+    last_servo_tick = timerval;
+
     switch (servo_state)
       {
         case IDLE:
@@ -1289,7 +1772,7 @@ void run_servo(void)
         case WF_INIT_DONE:
             // keep output for 500ms alive
             #if (SIMULATION == 0)
-                if ((char)(timerval - last_servo_run) < (500000L / TICK_PERIOD))  return;
+                if ((char)(timerval - last_servo_run) < (500000L / TICK_PERIOD))  break;
             #endif
 
             last_servo_run = timerval;                    // remember time 
@@ -1301,42 +1784,29 @@ void run_servo(void)
             break;
 
         case WF_TIMESLOT:
-            // note: cast the difference down to char, otherwise the wrap around fails
-            
-            #if (SIMULATION == 0)
-                if ((char)(timerval - last_servo_run) < (UPDATE_PERIOD / TICK_PERIOD))  return;
-            #endif
-
-            // 20ms passed, now calc new servos values
+            // a frame (UPDATE_PERIOD) passed, now calc new servos values
             
             last_servo_run = timerval;              // remember time 
             
             // check for an update of positions
              
-            ocrval = calc_servo_next_val(0);
-            #if (SIMULATION != 0)
-                T1 = ocrval;
-            #endif
-            if (my_eeprom_read_byte(&CV.Sv1_Mode) & (1 << CVbit_SvMode_KeepOn))
-              {
-                if (ocrval != 0) set_servo_valA(ocrval);     // keep old value in case of no movement
-              }
-            else
-              {
-                set_servo_valA(ocrval);                      // always update
-              }
-
-            ocrval = calc_servo_next_val(1);
-            #if (SIMULATION != 0)
-                T2 = ocrval;
-            #endif
-            if (my_eeprom_read_byte(&CV.Sv2_Mode) & (1 << CVbit_SvMode_KeepOn))
-              {
-                if (ocrval != 0) set_servo_valB(ocrval);     // keep old value in case of no movement
-              }
-            else
+            for (i=0; i<NO_OF_SERVOS; i++)
               {
-                set_servo_valB(ocrval);                      // always update
+                if (!tick && (servo[i].frames == 1)) continue;  // 20ms servo: once per timetick
+
+                ocrval = calc_servo_next_val(i);
+                #if (SIMULATION != 0)
+                    if (i == 0) T1 = ocrval;
+                    if (i == 1) T2 = ocrval;
+                #endif
+                if (my_eeprom_read_byte(SV_CV(i, Mode)) & (1 << CVbit_SvMode_KeepOn))
+                  {
+                    if (ocrval != 0) set_servo_val(i, ocrval);  // keep old value in case of no movement
+                  }
+                else
+                  {
+                    set_servo_val(i, ocrval);                   // always update
+                  }
               }
 
             // Flasher
@@ -1345,7 +1815,7 @@ void run_servo(void)
               {
                 my_output(PB0,0);                                    // turn off
                 flash = 0;
-                flash_period = 20;            // 400ms
+                flash_period = 20 * SERVO_FRAMES;            // 400ms
               }
 
             if (servo[0].control & (1<<SC_BIT_MOVING))
@@ -1364,74 +1834,57 @@ void run_servo(void)
 
             break;
      }
+
+    servo_frame_out(tick);                  // pulses of the next frame
   }
 
 
-void copy_curve(unsigned char curve_ean, unsigned char myservo)
+// select_curve: the curve of the next move of this servo; it is read point by
+// point (read_curve_point), there is no copy in ram.
+void select_curve(unsigned char curve_ean, unsigned char myservo)
   {
-    t_curve_point *dest;
-    t_curve_point *src;
     unsigned char my_curve_ean;
-    unsigned char i;
+    const unsigned char *src;
 
     my_curve_ean = curve_ean & 0x7F;
+    #if (SERVO_PLAN == TRUE)
+    if (my_curve_ean == CURVE_PLAN)
+      {
+        servo[myservo].curve_ean = CURVE_PLAN;              // no curve, see plan_start
+        return;
+      }
+    #endif
+    if (ee_curve_nr(my_curve_ean))
+      {
+        src = ee_curve(ee_curve_nr(my_curve_ean));
+        if (src)
+          {
+            servo[myservo].curve_ean = my_curve_ean;
+            servo[myservo].curve = src;
+            return;
+          }
+        my_curve_ean = 5;  // no such curve: default
+      }
     if (my_curve_ean >= (sizeof(pre_def_curves)/sizeof(pre_def_curves[0])))
       my_curve_ean = 5;  // default
 
-    dest = servo[myservo].curve;
-    src = pre_def_curves[my_curve_ean];
-
-    switch(my_curve_ean)
-      {
-        case 0: // reserved
-        case 1: // eeprom
-        case 2: // eeprom
-        case 3: // eeprom
-        case 4: // eeprom
-            // copy one less, to keep zero at end of memory
-            // thus the curve is always terminated 
-            for (i=0; i<(SIZE_SERVO_CURVE-1); i++)
-              {
-                dest->time = my_eeprom_read_byte(&src->time);        
-                dest->position = my_eeprom_read_byte(&src->position);
-                dest++;
-                src++;
-              } 
-
-            break;
-        case 5:
-        case 6:
-        case 7:
-        case 8:
-        case 9:
-        case 10:
-        case 11:
-        case 12:
-        case 13:
-        case 14:
-        case 15:
-        default:
-            // memcpy_P((void *)dest, (PGM_VOID_P)src, SIZE_SERVO_CURVE*sizeof(t_curve_point));
-            // copy one less, to keep zero at end of memory
-            for (i=0; i<(SIZE_SERVO_CURVE-1); i++)
-              {
-                dest->time = pgm_read_byte(&src->time);         // check end of list!!
-                dest->position = pgm_read_byte(&src->position);
-                dest++;
-                src++;
-              } 
-
-            break;
-      }
+    servo[myservo].curve_ean = my_curve_ean;
+    servo[myservo].curve = (const unsigned char *) pre_def_curves[my_curve_ean];
   }
 
 
 #if (USE4567_FOR_ADJUST == TRUE) 
+// index: the last servo command; servo = index / 2, 
+//        even: endpoint min (end of move B), odd: endpoint max (end of move A)
+
 void increment_last_position(unsigned char index)
   {
     unsigned char manincr;
     unsigned int incr;
     unsigned long temp;
+    unsigned char nr = index >> 1;
+
+    if (nr >= NO_OF_SERVOS) return;
 
     manincr = my_eeprom_read_byte(&CV.ManIncr);
     if (manincr == 0) manincr=1;
@@ -1440,49 +1893,32 @@ void increment_last_position(unsigned char index)
                                               // 4096 steps for small incr
 
     servo_state = IDLE;                       // reset servo engine to get a 500ms chain of pulses
-    switch(index)
+    if (index & 1)
       {
-        case 0:
-            temp = (unsigned long)servo[0].min + (unsigned long)incr;
-            if (temp < 65536L)
-              {
-                servo[0].min = (unsigned int)temp;
-              }
-            move_servo_to_start(0);
-            break;
-        case 1:
-            temp = (unsigned long)servo[0].max + (unsigned long)incr;
-            if (temp < 65536L)
-              {
-                servo[0].max = (unsigned int)temp;
-              }
-            move_servo_to_start(0);
-            break;
-        case 2:
-            temp = (unsigned long)servo[1].min + (unsigned long)incr;
-            if (temp < 65536L)
-              {
-                servo[1].min = (unsigned int)temp;
-              }
-            move_servo_to_start(1);
-            break;
-        case 3:
-            temp = (unsigned long)servo[1].max + (unsigned long)incr;
-            if (temp < 65536L)
-              {
-                servo[1].max = (unsigned int)temp;
-              }
-            move_servo_to_start(1);
-            break;
-        default:
-            return;
+        temp = (unsigned long)servo[nr].max + (unsigned long)incr;
+        if (temp < 65536L)
+          {
+            servo[nr].max = (unsigned int)temp;
+          }
+      }
+    else
+      {
+        temp = (unsigned long)servo[nr].min + (unsigned long)incr;
+        if (temp < 65536L)
+          {
+            servo[nr].min = (unsigned int)temp;
+          }
       }
+    move_servo_to_start(nr);
   }
 
 void decrement_last_position(unsigned char index)
   {
     unsigned char manincr;
     unsigned int incr;
+    unsigned char nr = index >> 1;
+
+    if (nr >= NO_OF_SERVOS) return;
 
     manincr = my_eeprom_read_byte(&CV.ManIncr);
     if (manincr == 0) manincr=1;
@@ -1491,72 +1927,44 @@ void decrement_last_position(unsigned char index)
                                               // 4096 steps for small incr
 
     servo_state = IDLE;                       // reset servo engine to get a 500ms chain of pulses
-    switch(index)
+    if (index & 1)
       {
-        case 0:
-            if (servo[0].min > incr) servo[0].min -= incr;
-            move_servo_to_start(0);
-            break;
-        case 1:
-            if (servo[0].max > incr) servo[0].max -= incr;
-            move_servo_to_start(0);
-            break;
-        case 2:
-            if (servo[1].min > incr) servo[1].min -= incr;
-            move_servo_to_start(1);
-            break;
-        case 3:
-            if (servo[1].max > incr) servo[1].max -= incr;
-            move_servo_to_start(1);
-            break;
-        default:
-            return;
+        if (servo[nr].max > incr) servo[nr].max -= incr;
+      }
+    else
+      {
+        if (servo[nr].min > incr) servo[nr].min -= incr;
       }
+    move_servo_to_start(nr);
   }
 
 void save_last_position(unsigned char index)
   {
-    switch(index)
+    unsigned char nr = index >> 1;
+
+    if (nr >= NO_OF_SERVOS) return;
+
+    if (index & 1)
       {
-        case 0:
-            my_eeprom_write_byte(&CV.Sv1_minL, (unsigned char) servo[0].min);
-            my_eeprom_write_byte(&CV.Sv1_min, (unsigned char) (servo[0].min >> 8));
-            break;
-        case 1:
-            my_eeprom_write_byte(&CV.Sv1_maxL, (unsigned char) servo[0].max);
-            my_eeprom_write_byte(&CV.Sv1_max, (unsigned char) (servo[0].max >> 8));
-            break;
-        case 2:
-            my_eeprom_write_byte(&CV.Sv2_minL, (unsigned char) servo[1].min);
-            my_eeprom_write_byte(&CV.Sv2_min, (unsigned char) (servo[1].min >> 8));
-            break;
-        case 3:
-            my_eeprom_write_byte(&CV.Sv2_maxL, (unsigned char) servo[1].max);
-            my_eeprom_write_byte(&CV.Sv2_max, (unsigned char) (servo[1].max >> 8));
-            break;
-        default:
-            return;
+        my_eeprom_write_byte(SV_CV(nr, maxL), (unsigned char) servo[nr].max);
+        my_eeprom_write_byte(SV_CV(nr, max), (unsigned char) (servo[nr].max >> 8));
+      }
+    else
+      {
+        my_eeprom_write_byte(SV_CV(nr, minL), (unsigned char) servo[nr].min);
+        my_eeprom_write_byte(SV_CV(nr, min), (unsigned char) (servo[nr].min >> 8));
       }
   }
 
 unsigned char is_manual_adjust_allowed(unsigned char index)
   {
     unsigned char temp;
-    switch(index)
-      {
-        case 0:
-        case 1:
-            temp = my_eeprom_read_byte(&CV.Sv1_Mode);
-            if (temp & (1 << CVbit_SvMode_ADJ)) return(TRUE);
-            break;
-        case 2:
-        case 3:
-            temp = my_eeprom_read_byte(&CV.Sv2_Mode);
-            if (temp & (1 << CVbit_SvMode_ADJ)) return(TRUE);
-            break;
-        default:
-            break;
-      }
+    unsigned char nr = index >> 1;
+
+    if (nr >= NO_OF_SERVOS) return(FALSE);
+
+    temp = my_eeprom_read_byte(SV_CV(nr, Mode));
+    if (temp & (1 << CVbit_SvMode_ADJ)) return(TRUE);
     return(FALSE);
 
   }
@@ -1574,153 +1982,105 @@ unsigned char is_manual_adjust_allowed(unsigned char index)
 void do_servo(unsigned char nr, unsigned char move)
   {
     load_min_max();
-    if (nr == 0)
+    if (nr >= NO_OF_SERVOS) return;
+
+    if (servo[nr].control & (1<<SC_BIT_OUT_CTRL))
       {
-        if (servo[0].control & (1<<SC_BIT_OUT_CTRL))
-          {
-            my_output(PB0,0);                                    // turn off both
-            my_output(PB1,0); 
-          }  
-        switch(move)
-          {
-            case MOVE2A: // Servo 1, move A
-                copy_curve(my_eeprom_read_byte(&CV.Sv1_CurveA), 0);
-                servo[0].time_ratio = my_eeprom_read_byte(&CV.Sv1_TimeA);
-                servo[0].curve_index = 1;
-                servo[0].active_time = 0;
-                servo[0].control |= (1<<SC_BIT_MOVING);
-                break;
-            case MOVE2B: // Servo 1, move B
-                copy_curve(my_eeprom_read_byte(&CV.Sv1_CurveB), 0);
-                servo[0].time_ratio = my_eeprom_read_byte(&CV.Sv1_TimeB);
-                servo[0].curve_index = 1;
-                servo[0].active_time = 0;
-                servo[0].control |= (1<<SC_BIT_MOVING);
-                break;
-          }
-      }
-     if (nr == 1)
+        my_output(2*nr, 0);                                  // turn off both
+        my_output(2*nr+1, 0); 
+      }  
+    switch(move)
       {
-        if (servo[1].control & (1<<SC_BIT_OUT_CTRL))
-          {
-            my_output(PB2,0);                                    // turn off both
-            my_output(PB3,0); 
-          }  
-        switch(move)
-          {
-            case MOVE2A: // Servo 2, move A
-                copy_curve(my_eeprom_read_byte(&CV.Sv2_CurveA), 1);
-                servo[1].time_ratio = my_eeprom_read_byte(&CV.Sv2_TimeA);
-                servo[1].curve_index = 1;
-                servo[1].active_time = 0;
-                servo[1].control |= (1<<SC_BIT_MOVING);
-                break;
-            case MOVE2B: // Servo 2, move B
-                copy_curve(my_eeprom_read_byte(&CV.Sv2_CurveB), 1);
-                servo[1].time_ratio = my_eeprom_read_byte(&CV.Sv2_TimeB);
-                servo[1].curve_index = 1;
-                servo[1].active_time = 0;
-                servo[1].control |= (1<<SC_BIT_MOVING);
-                break;
-          }
+        case MOVE2A: // move A
+            select_curve(my_eeprom_read_byte(SV_CV(nr, CurveA)), nr);
+            servo[nr].time_ratio = my_eeprom_read_byte(SV_CV(nr, TimeA));
+            servo[nr].curve_index = 0;
+            servo[nr].active_time = 0;
+            servo[nr].sub = 0;
+            servo[nr].control |= (1<<SC_BIT_MOVING);
+            break;
+        case MOVE2B: // move B
+            select_curve(my_eeprom_read_byte(SV_CV(nr, CurveB)), nr);
+            servo[nr].time_ratio = my_eeprom_read_byte(SV_CV(nr, TimeB));
+            servo[nr].curve_index = 0;
+            servo[nr].active_time = 0;
+            servo[nr].sub = 0;
+            servo[nr].control |= (1<<SC_BIT_MOVING);
+            break;
       }
   }
 
 
 unsigned char LastServoCommand = 0;
 
+// Command 2*n:   servo n+1, move B (or terminate, if permanent)
+// Command 2*n+1: servo n+1, move A
+// the four commands after the servos (4..7, with SERVO_MUX 16..19):
+// outputs or manual adjustment of the last servo command
+// (8 commands per address: with SERVO_MUX, servo 5..8 are on MyAddr+1 and the
+// adjust commands on MyAddr+2, so CV.AddrRange must be 3)
+
 void servo_action(unsigned int Command)
   {
-    unsigned char myCommand; // unsigned char myTurnout;
+    unsigned char myCommand;
+    unsigned char nr;
     unsigned char temp;
-    myCommand = Command & 0b00000111;
-    // myTurnout = myCommand >> 1;
 
-    if (Command > 7) return;
-    
-    switch(myCommand)
+    if (Command >= (2 * NO_OF_SERVOS + 4)) return;
+
+    if (Command < (2 * NO_OF_SERVOS))
       {
-        case 0:
-            LastServoCommand = myCommand;
-            temp = my_eeprom_read_byte(&CV.Sv1_Mode);
+        nr = Command >> 1;
+        LastServoCommand = Command;
+        if ((Command & 1) == 0)
+          {
+            temp = my_eeprom_read_byte(SV_CV(nr, Mode));
             if (temp & (1 << CVbit_SvMode_MOVMOD))
               {
                 // Es ist ein Dauerlaeufer, dann nur ein Flag setzen,
                 // dass es sauber heinlaufen soll.
-                servo[0].control |= (1<<SC_BIT_TERMINATE);       // set flag for terminate
+                servo[nr].control |= (1<<SC_BIT_TERMINATE);      // set flag for terminate
               }
             else
               {
-                if ( ( (servo[0].control & (1<<SC_BIT_ACTUAL))) &&
-                     (!(servo[0].control & (1<<SC_BIT_MOVING)))  ) 
+                if ( ( (servo[nr].control & (1<<SC_BIT_ACTUAL))) &&
+                     (!(servo[nr].control & (1<<SC_BIT_MOVING)))  ) 
                   {                             
                     // Servo steht auf anderer Seite und bewegt sich nicht, 
                     // also hier die andere Bewegung starten.
-                    do_servo(0, MOVE2B);
+                    do_servo(nr, MOVE2B);
                   }
               }
-            break;
-        case 1:
-            LastServoCommand = myCommand;
-            servo[0].repeat = my_eeprom_read_byte(&CV.Sv1_Repeat);
-            temp = my_eeprom_read_byte(&CV.Sv1_Mode);
+          }
+        else
+          {
+            servo[nr].repeat = my_eeprom_read_byte(SV_CV(nr, Repeat));
+            temp = my_eeprom_read_byte(SV_CV(nr, Mode));
             if (temp & (1 << CVbit_SvMode_MOVMOD))
               {
-                if ( (!(servo[0].control & (1<<SC_BIT_MOVING)))  )
+                if ( (!(servo[nr].control & (1<<SC_BIT_MOVING)))  )
                   {
-                    servo[0].control &= ~(1<<SC_BIT_TERMINATE); // no terminate
-                    servo[0].control |= (1<<SC_BIT_REPEAT);     // set flag for permanent
-                    do_servo(0, MOVE2A);
+                    servo[nr].control &= ~(1<<SC_BIT_TERMINATE); // no terminate
+                    servo[nr].control |= (1<<SC_BIT_REPEAT);     // set flag for permanent
+                    do_servo(nr, MOVE2A);
                   }
               }
             else
               {
-                if ( (!(servo[0].control & (1<<SC_BIT_ACTUAL))) &&
-                     (!(servo[0].control & (1<<SC_BIT_MOVING)))  )
+                if ( (!(servo[nr].control & (1<<SC_BIT_ACTUAL))) &&
+                     (!(servo[nr].control & (1<<SC_BIT_MOVING)))  )
                   {                          // run A only if pre A and not moving
-                    do_servo(0, MOVE2A);
+                    do_servo(nr, MOVE2A);
                   }
               }
-            break;
+          }
+        return;
+      }
 
-        case 2:
-            LastServoCommand = myCommand;
-            temp = my_eeprom_read_byte(&CV.Sv2_Mode);
-            if (temp & (1 << CVbit_SvMode_MOVMOD))
-              {
-                servo[1].control |= (1<<SC_BIT_TERMINATE);       // set flag for terminate
-              }
-            else
-              {
-                if ( ( (servo[1].control & (1<<SC_BIT_ACTUAL))) &&
-                     (!(servo[1].control & (1<<SC_BIT_MOVING)))  ) 
-                  {                             // run A only if pre A and not moving
-                    do_servo(1, MOVE2B);
-                  }
-              }
-            break;
-        case 3:
-            LastServoCommand = myCommand;
-            servo[1].repeat = my_eeprom_read_byte(&CV.Sv2_Repeat);
-            temp = my_eeprom_read_byte(&CV.Sv2_Mode);
-            if (temp & (1 << CVbit_SvMode_MOVMOD))
-              {
-                if ( (!(servo[1].control & (1<<SC_BIT_MOVING)))  )
-                  {
-                    servo[1].control &= ~(1<<SC_BIT_TERMINATE); // no terminate
-                    servo[1].control |= (1<<SC_BIT_REPEAT);     // set flag for permanent
-                    do_servo(1, MOVE2A);
-                  }
-              }
-            else
-              {
-                if ( (!(servo[1].control & (1<<SC_BIT_ACTUAL))) &&
-                     (!(servo[1].control & (1<<SC_BIT_MOVING)))  )
-                  {
-                    do_servo(1, MOVE2A);
-                  }
-              }
-            break;
+    myCommand = Command - (2 * NO_OF_SERVOS) + 4;
+
+    switch(myCommand)
+      {
     #if (USE4567_FOR_ADJUST == FALSE) 
         case 4:
             my_output(PB4,1);
@@ -1788,26 +2148,13 @@ void servo_action(unsigned int Command)
 void servo_key_action(unsigned int Command)                    // execute the key command
   {
     unsigned char temp;
-    switch(Command)
+
+    if (Command >= (2 * NO_OF_SERVOS)) return;                  // ignore all other commands
+
+    temp = my_eeprom_read_byte(SV_CV(Command >> 1, Mode));
+    if (temp & (1 << CVbit_SvMode_MAN))
       {
-        case 0:
-        case 1:
-            temp = eeprom_read_byte(&CV.Sv1_Mode);
-            if (temp & (1 << CVbit_SvMode_MAN))
-              {
-                servo_action(Command);
-              }
-            break;
-        case 2:
-        case 3:
-            temp = eeprom_read_byte(&CV.Sv2_Mode);
-            if (temp & (1 << CVbit_SvMode_MAN))
-              {
-                servo_action(Command);
-              }
-            break;
-        default:
-            break; // ignore all other commands
+        servo_action(Command);
       }
   }
 
@@ -1930,20 +2277,26 @@ void init_segment(void)
     servo[0].min = table_position[last_position];
     servo[0].max = table_position[last_position];
 
-    set_servo_valA(calc_servo_single_val(0, 128));                  // dont care, min + max are equal
+    set_servo_val(0, calc_servo_single_val(0, 128));               // dont care, min + max are equal
+
+    #if (SERVO_MUX == TRUE)
+        init_servo_mux();                   // pulses start with run_servo
+    #else
+        // now enable these OCR outputs
 
-    // now enable these OCR outputs
+        servo_frame_out(1);                 // first pulses, before the outputs are on
 
-    signed char my_timerval;
-    my_timerval = timerval;
-    while (my_timerval == timerval);    // wait for a good moment to enable pulses
+        signed char my_timerval;
+        my_timerval = timerval;
+        while (my_timerval == timerval) HOST_WAIT();    // wait for a good moment to enable pulses
 
-    // OC1A and OC1B are mapped to Timer (for Servo Operation)
+        // OC1A and OC1B are mapped to Timer (for Servo Operation)
 
-    TCCR1A |= (1 << COM1A1)          // compare match A
-            | (1 << COM1A0)          // set OC1A/OC1B on Compare Match, clear OC1A/OC1B at TOP
-            | (1 << COM1B1)          // compare match B
-            | (1 << COM1B0);
+        TCCR1A |= (1 << COM1A1)          // compare match A
+                | (1 << COM1A0)          // set OC1A/OC1B on Compare Match, clear OC1A/OC1B at TOP
+                | (1 << COM1B1)          // compare match B
+                | (1 << COM1B0);
+    #endif
   }
 
 
@@ -1968,7 +2321,7 @@ void increment_position(unsigned char index)
     servo[0].min = table_position[index];
     servo[0].max = table_position[index];
 
-    set_servo_valA(calc_servo_single_val(0, 128));                  // dont care, min + max are equal
+    set_servo_val(0, calc_servo_single_val(0, 128));               // dont care, min + max are equal
   }
 
 void decrement_position(unsigned char index)
@@ -1989,7 +2342,7 @@ void decrement_position(unsigned char index)
     servo[0].min = table_position[index];
     servo[0].max = table_position[index];
 
-    set_servo_valA(calc_servo_single_val(0, 128));                  // dont care, min + max are equal
+    set_servo_val(0, calc_servo_single_val(0, 128));               // dont care, min + max are equal
   }
 
 void save_position(unsigned char index)
@@ -2008,6 +2361,9 @@ void save_position(unsigned char index)
 //
 // calc_curve generates a new servo curve, loads this curve
 // to servo[0] and starts it.
+
+t_curve_point segment_curve[SIZE_SERVO_CURVE];      // last entry stays zero
+
 unsigned char calc_curve(unsigned char start_i, unsigned char dest_i)
   {
     unsigned int mystart, mydest, delta;
@@ -2064,7 +2420,7 @@ unsigned char calc_curve(unsigned char start_i, unsigned char dest_i)
 
     // now scale and copy to servo array
 
-    dest = servo[0].curve;
+    dest = segment_curve;
 
     unsigned char i;
     for (i=0; i<(SIZE_SERVO_CURVE-1); i++)
@@ -2075,9 +2431,12 @@ unsigned char calc_curve(unsigned char start_i, unsigned char dest_i)
         src++;
       } 
 
+    servo[0].curve_ean = CURVE_RAM;
+    servo[0].curve = (const unsigned char *) segment_curve;
     servo[0].time_ratio = my_eeprom_read_byte(&CV.Pos_Time);
-    servo[0].curve_index = 1;
+    servo[0].curve_index = 0;
     servo[0].active_time = 0;
+    servo[0].sub = 0;
     servo[0].control |= (1<<SC_BIT_MOVING);
 
     return(TRUE);
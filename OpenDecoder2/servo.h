@@ -16,6 +16,7 @@
 // webpage:   http://www.opendcc.de
 // history:   2007-02-14 V0.1 kw copied from opendecoder.c
 //            2011-12-12         added key_action
+//            2026-10-17         codes of the eeprom curves
 //
 //------------------------------------------------------------------------
 //
@@ -37,3 +38,12 @@ void servo_action2(unsigned int Command);               // execute the decoded c
 void servo_key_action(unsigned int Command);            // execute the key command
 
 void run_servo(void);                                   // timertask, must be called in a loop
+
+// eeprom curves (EE_servo_curves in config.c): directory and delta coded
+// curves, see servo.c
+#define SV_CURVES             16        // user curves (curve number 1..4, 17..28)
+#define SV_CURVE_POOL         192       // bytes of EE_servo_curves
+
+#define SVC_STEP(dt, dpos)    ((((dt) - 1) << 6) | ((dpos) & 0x3F))  // dt 1..2, dpos -32..31
+#define SVC_JUMP(dt)          (0x80 | (dt))                         // dt 1..127, then position
+#define SVC_END               0x80
@@ -0,0 +1,484 @@
+#!/usr/bin/env python3
+#------------------------------------------------------------------------
+#
+# OpenDCC - OpenDecoder2
+#
+# This source file is subject of the GNU general public license 2,
+# that is available at the world-wide-web at
+# http://www.gnu.org/licenses/gpl.txt
+#
+#------------------------------------------------------------------------
+#
+# file:      isr_cycles.py
+# history:   2026-10-17 V0.1 start
+#            2026-10-17 V0.2 build options (--define, if NAME=VALUE)
+#                            paths 'to_' a source line
+#
+#------------------------------------------------------------------------
+#
+# purpose:   worst case cycle count of the interrupt service routines,
+#            taken from the disassembly of the ELF (default/Makefile).
+#            Fails (exit code 1) if a path exceeds its budget.
+#
+# usage:     isr_cycles.py [--objdump avr-objdump] [--mcu atmega8515]
+#                          [--listing file] [--define NAME=VALUE ...]
+#                          elf budgetfile
+#
+#            --listing: use an existing output of 'avr-objdump -d -l'
+#                       instead of running avr-objdump.
+#            --define:  build option the ELF was made with (the makefile
+#                       passes the same as to the compiler), selects the
+#                       rules with 'if'.
+#
+# howto:     avr-objdump -d -l gives instructions and source lines.
+#            Starting at __vector_N, every reachable instruction is a
+#            node; edges carry the cycles of the instruction for this
+#            outcome (branch taken / not taken, skip 1 or 2 words).
+#            Calls add the worst case of the callee (incl. ret).
+#            Loops must have a bound in the budget file; the loop body
+#            (header -> back edge) is added (bound-1) times to the header.
+#            The worst path is the longest path of the remaining DAG.
+#            A path 'through' a source line is the longest path that
+#            passes one of the instructions generated for this line.
+#            'to_sei' is the longest path from entry to the first sei -
+#            this is the time the ISR blocks all other interrupts.
+#
+#            All counts include the interrupt response (4 cycles) and
+#            the rjmp in the vector table (2 cycles), see --entry.
+#
+# budgetfile (one rule per line, '#' comment, regex in quotes):
+#
+#   vector  <name>_vect  <path>  <file>|-  <regex>|-  <budget>
+#   loop    <file>  <regex>|-  <max. iterations>
+#   define  <NAME>  <value>
+#   if <NAME>=<value>[,<value>...]  <vector or loop rule>
+#
+#   path is a free name; with '-' as file the whole ISR is checked,
+#   path 'to_sei' checks the time until the first sei; any other path
+#   'to_...' with a file checks the time until the source line is
+#   reached (e.g. the first write to a data register).
+#   A path whose source line is not in the build (e.g. switched off
+#   in config.h) is reported as n/a and not checked.
+#   A loop with '-' as regex is any loop of the file (for headers
+#   outside the sources, like util/delay_basic.h).
+#   'define' gives the default of a build option (as in the source);
+#   --define overrides it. A rule with 'if' is used only when the
+#   option has one of the values; several 'if' may precede a rule.
+#
+#------------------------------------------------------------------------
+
+import argparse
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+# vector numbers (__vector_N) of the supported processors
+VECTORS = {
+    'atmega8515': {
+        'INT0_vect': 1, 'INT1_vect': 2, 'TIMER1_CAPT_vect': 3,
+        'TIMER1_COMPA_vect': 4, 'TIMER1_COMPB_vect': 5, 'TIMER1_OVF_vect': 6,
+        'TIMER0_OVF_vect': 7, 'SPI_STC_vect': 8, 'USART_RX_vect': 9,
+        'USART_UDRE_vect': 10, 'USART_TX_vect': 11, 'ANA_COMP_vect': 12,
+        'INT2_vect': 13, 'TIMER0_COMP_vect': 14, 'EE_RDY_vect': 15,
+        'SPM_RDY_vect': 16,
+    },
+    'atmega162': {
+        'INT0_vect': 1, 'INT1_vect': 2, 'INT2_vect': 3, 'PCINT0_vect': 4,
+        'PCINT1_vect': 5, 'TIMER3_CAPT_vect': 6, 'TIMER3_COMPA_vect': 7,
+        'TIMER3_COMPB_vect': 8, 'TIMER3_OVF_vect': 9, 'TIMER2_COMP_vect': 10,
+        'TIMER2_OVF_vect': 11, 'TIMER1_CAPT_vect': 12, 'TIMER1_COMPA_vect': 13,
+        'TIMER1_COMPB_vect': 14, 'TIMER1_OVF_vect': 15, 'TIMER0_COMP_vect': 16,
+        'TIMER0_OVF_vect': 17, 'SPI_STC_vect': 18, 'USART0_RX_vect': 19,
+        'USART1_RX_vect': 20, 'USART0_UDRE_vect': 21, 'USART1_UDRE_vect': 22,
+        'USART0_TX_vect': 23, 'USART1_TX_vect': 24, 'EE_RDY_vect': 25,
+        'ANA_COMP_vect': 26, 'SPM_RDY_vect': 27,
+    },
+}
+
+# cycles of the AVR core (mega8515 / mega162, 16 bit PC);
+# branches, skips, calls and returns are handled separately
+CYCLES_2 = {'ld', 'ldd', 'lds', 'st', 'std', 'sts', 'push', 'pop', 'sbi',
+            'cbi', 'adiw', 'sbiw', 'mul', 'muls', 'mulsu', 'fmul', 'fmuls',
+            'fmulsu', 'rjmp', 'ijmp'}
+CYCLES_3 = {'lpm', 'elpm', 'jmp'}
+CALLS = {'rcall': 3, 'call': 4, 'icall': 3, 'eicall': 4}
+SKIPS = {'cpse', 'sbrc', 'sbrs', 'sbic', 'sbis'}
+RETURNS = {'ret': 4, 'reti': 4}
+INDIRECT = {'ijmp', 'eijmp', 'icall', 'eicall'}
+BRANCH = re.compile(r'^br[a-z]{2}$')
+
+INSN = re.compile(r'^\s*([0-9a-f]+):\t((?:[0-9a-f]{2} )+)\s*\t?(\S+)\s*([^;]*)(?:;\s*0x([0-9a-f]+))?')
+LINE = re.compile(r'^(\S+):(\d+)(?: \(discriminator \d+\))?$')
+SYMBOL = re.compile(r'^[0-9a-f]+ <(\S+)>:$')
+
+
+class CycleError(Exception):
+    pass
+
+
+class Insn:
+    def __init__(self, addr, size, op, args, target, src):
+        self.addr = addr
+        self.size = size
+        self.op = op
+        self.args = args
+        self.target = target
+        self.src = src                          # (file, line) or None
+
+
+#------------------------------------------------------------------------
+# disassembly
+
+def read_listing(text):
+    insns = {}
+    symbols = {}
+    src = None
+    for line in text.splitlines():
+        m = SYMBOL.match(line)
+        if m:
+            symbols[m.group(1)] = int(line.split()[0], 16)
+            continue
+        m = LINE.match(line)
+        if m:
+            src = (os.path.basename(m.group(1)), int(m.group(2)))
+            continue
+        m = INSN.match(line)
+        if m:
+            addr = int(m.group(1), 16)
+            size = len(m.group(2).split())
+            target = int(m.group(5), 16) if m.group(5) else None
+            if target is None and m.group(3) in ('jmp', 'call'):
+                target = int(m.group(4).strip(), 16)
+            insns[addr] = Insn(addr, size, m.group(3), m.group(4).strip(), target, src)
+    return insns, symbols
+
+
+class Source:
+    # source lines, searched relative to the directory of the listing
+    def __init__(self, dirs):
+        self.dirs = dirs
+        self.files = {}
+
+    def text(self, src):
+        if src is None:
+            return ''
+        name, line = src
+        if name not in self.files:
+            self.files[name] = []
+            for d in self.dirs:
+                path = os.path.join(d, name)
+                if os.path.exists(path):
+                    with open(path, encoding='latin-1') as f:
+                        self.files[name] = f.read().splitlines()
+                    break
+        lines = self.files[name]
+        return lines[line - 1] if 0 < line <= len(lines) else ''
+
+    def match(self, src, name, regex):
+        if src is None or src[0] != name:
+            return False
+        return regex is None or re.search(regex, self.text(src))
+
+
+#------------------------------------------------------------------------
+# control flow graph and longest path
+
+EXIT = -1
+
+
+class Analyzer:
+    def __init__(self, insns, source, loops):
+        self.insns = insns
+        self.source = source
+        self.loops = loops                      # [(file, regex, bound)]
+        self.callee = {}                        # addr -> wcet incl. ret
+
+    def insn(self, addr):
+        if addr not in self.insns:
+            raise CycleError('no instruction at 0x%x' % addr)
+        return self.insns[addr]
+
+    def edges(self, i):
+        # (successor, cycles) of one instruction
+        nxt = i.addr + i.size
+        if i.op in RETURNS:
+            return [(EXIT, RETURNS[i.op])]
+        if i.op in INDIRECT:
+            raise CycleError('indirect jump/call at 0x%x (%s:%s)' %
+                             (i.addr, i.src[0] if i.src else '?', i.src[1] if i.src else '?'))
+        if i.op in CALLS:
+            return [(nxt, CALLS[i.op] + self.wcet_call(i.target))]
+        if i.op in ('rjmp', 'jmp'):
+            return [(i.target, 2 if i.op == 'rjmp' else 3)]
+        if BRANCH.match(i.op):
+            return [(nxt, 1), (i.target, 2)]
+        if i.op in SKIPS:
+            skipped = self.insn(nxt)
+            return [(nxt, 1), (nxt + skipped.size, 2 if skipped.size == 2 else 3)]
+        if i.op in CYCLES_2:
+            return [(nxt, 2)]
+        if i.op in CYCLES_3:
+            return [(nxt, 3)]
+        return [(nxt, 1)]
+
+    def graph(self, entry):
+        succ = {}
+        todo = [entry]
+        while todo:
+            a = todo.pop()
+            if a in succ or a == EXIT:
+                continue
+            succ[a] = self.edges(self.insn(a))
+            todo.extend(s for s, c in succ[a])
+        return succ
+
+    def back_edges(self, entry, succ):
+        back = set()
+        state = {}
+        stack = [(entry, iter(succ[entry]))]
+        state[entry] = 1
+        while stack:
+            node, it = stack[-1]
+            for s, c in it:
+                if s == EXIT:
+                    continue
+                if state.get(s) == 1:
+                    back.add((node, s))
+                elif s not in state:
+                    state[s] = 1
+                    stack.append((s, iter(succ[s])))
+                    break
+            else:
+                state[node] = 2
+                stack.pop()
+        return back
+
+    def loop_bound(self, header, latch):
+        for name, regex, bound in self.loops:
+            for a in (header, latch):
+                if self.source.match(self.insns[a].src, name, regex):
+                    return bound
+        src = self.insns[latch].src
+        raise CycleError('no loop bound for loop at 0x%x (%s:%s)' %
+                         (header, src[0] if src else '?', src[1] if src else '?'))
+
+    def longest(self, entry, dag, weight, nodes=None, stop=None, end=EXIT):
+        # longest path from entry on the dag, node weights included;
+        # 'nodes' limits the search, at 'stop' nodes the path ends
+        dist = {entry: weight.get(entry, 0)}
+        for n in self.topo(entry, dag, nodes, stop, end):
+            if n not in dist or (stop and n in stop):
+                continue
+            for s, c in dag[n]:
+                if nodes is not None and s not in nodes and s != end:
+                    continue
+                d = dist[n] + c + weight.get(s, 0)
+                if d > dist.get(s, -1):
+                    dist[s] = d
+        return dist
+
+    def topo(self, entry, dag, nodes, stop, end):
+        order = []
+        seen = set()
+        stack = [(entry, False)]
+        while stack:
+            n, done = stack.pop()
+            if done:
+                order.append(n)
+                continue
+            if n in seen or n == end or (nodes is not None and n not in nodes):
+                continue
+            seen.add(n)
+            stack.append((n, True))
+            if stop and n in stop:
+                continue
+            for s, c in dag[n]:
+                stack.append((s, False))
+        order.reverse()
+        return order
+
+    def prepare(self, entry):
+        # graph without back edges, loop costs as node weights
+        succ = self.graph(entry)
+        back = self.back_edges(entry, succ)
+        dag = {n: [(s, c) for s, c in e if (n, s) not in back] for n, e in succ.items()}
+        pred = {}
+        for n, e in succ.items():
+            for s, c in e:
+                pred.setdefault(s, set()).add(n)
+        loops = {}                              # header -> (latches, body)
+        for latch, header in back:
+            latches, body = loops.setdefault(header, ([], {header}))
+            latches.append(latch)
+            todo = [latch]
+            while todo:
+                n = todo.pop()
+                if n not in body:
+                    body.add(n)
+                    todo.extend(pred.get(n, ()))
+        weight = {}
+        for header, (latches, body) in sorted(loops.items(), key=lambda l: len(l[1][1])):
+            bound = self.loop_bound(header, latches[0])
+            dist = self.longest(header, dag, weight, nodes=body)
+            iteration = max(dist[l] + c for l in latches for s, c in succ[l] if s == header)
+            weight[header] = weight.get(header, 0) + (bound - 1) * iteration
+        return succ, dag, weight
+
+    def wcet_call(self, addr):
+        if addr not in self.callee:
+            self.callee[addr] = None            # recursion guard
+            succ, dag, weight = self.prepare(addr)
+            self.callee[addr] = self.longest(addr, dag, weight)[EXIT]
+        if self.callee[addr] is None:
+            raise CycleError('recursive call to 0x%x' % addr)
+        return self.callee[addr]
+
+    def analyze(self, entry, anchors):
+        # returns dict path -> cycles (None = not in build)
+        succ, dag, weight = self.prepare(entry)
+        fwd = self.longest(entry, dag, weight)
+        rev = {}
+        for n, e in dag.items():
+            for s, c in e:
+                rev.setdefault(s, []).append((n, c))
+        for n in list(dag) + [EXIT]:
+            rev.setdefault(n, [])
+        bwd = self.longest(EXIT, rev, weight, end=None)
+        result = {}
+        for path, name, regex in anchors:
+            if path == 'to_sei' and name is None:
+                seis = {n for n in dag if self.insns[n].op == 'sei'}
+                if not seis:
+                    result[path] = fwd[EXIT]
+                    continue
+                dist = self.longest(entry, dag, weight, stop=seis)
+                # sei enables interrupts after the next instruction
+                result[path] = max(dist[n] + 1 + max(c for s, c in dag[self.next(n)])
+                                   for n in seis if n in dist)
+            elif name is None:
+                result[path] = fwd[EXIT]
+            elif path.startswith('to_'):
+                hits = {n for n in dag if self.source.match(self.insns[n].src, name, regex)}
+                dist = self.longest(entry, dag, weight, stop=hits)
+                reached = [dist[n] - weight.get(n, 0) for n in hits if n in dist]
+                result[path] = max(reached) if reached else None
+            else:
+                hits = [n for n in dag if self.source.match(self.insns[n].src, name, regex)]
+                hits = [n for n in hits if n in fwd and n in bwd]
+                if not hits:
+                    result[path] = None
+                else:
+                    result[path] = max(fwd[n] + bwd[n] - weight.get(n, 0) for n in hits)
+        return result
+
+    def next(self, addr):
+        return addr + self.insns[addr].size
+
+
+#------------------------------------------------------------------------
+
+def read_budget(filename, defines):
+    # defines: build options from the command line, completed here
+    # with the defaults of the budget file
+    vectors = []
+    loops = []
+    with open(filename) as f:
+        lines = list(enumerate(f, 1))
+    for no, line in lines:
+        words = shlex.split(line, comments=True)
+        if len(words) == 3 and words[0] == 'define':
+            defines.setdefault(words[1], words[2])
+    for no, line in lines:
+        words = shlex.split(line, comments=True)
+        selected = True
+        while len(words) > 2 and words[0] == 'if' and '=' in words[1]:
+            name, values = words[1].split('=', 1)
+            if name not in defines:
+                raise CycleError('%s:%d: %s has no default' % (filename, no, name))
+            selected = selected and defines[name] in values.split(',')
+            words = words[2:]
+        if not words or (words[0] == 'define' and len(words) == 3):
+            continue
+        if words[0] == 'vector' and len(words) == 6:
+            if not selected:
+                continue
+            vec, path, name, regex, budget = words[1:]
+            if name == '-':
+                name = regex = None
+            vectors.append((vec, path, name, regex, int(budget)))
+        elif words[0] == 'loop' and len(words) == 4:
+            if not selected:
+                continue
+            regex = None if words[2] == '-' else words[2]
+            loops.append((words[1], regex, int(words[3])))
+        else:
+            raise CycleError('%s:%d: syntax error' % (filename, no))
+    return vectors, loops
+
+
+def main():
+    parser = argparse.ArgumentParser(description='worst case cycles of the ISRs')
+    parser.add_argument('elf')
+    parser.add_argument('budget')
+    parser.add_argument('--objdump', default=os.environ.get('OBJDUMP', 'avr-objdump'))
+    parser.add_argument('--mcu', default='atmega8515', choices=sorted(VECTORS))
+    parser.add_argument('--listing', help='output of avr-objdump -d -l')
+    parser.add_argument('--source', action='append', default=[],
+                        help='directory with the sources (default: ..)')
+    parser.add_argument('--entry', type=int, default=4 + 2,
+                        help='interrupt response + vector table (default 6)')
+    parser.add_argument('--define', action='append', default=[], metavar='NAME=VALUE',
+                        help='build option, selects the rules with if')
+    args = parser.parse_args()
+
+    defines = {}
+    for d in args.define:
+        name, sep, value = d.partition('=')
+        if not sep:
+            parser.error('--define %s: NAME=VALUE expected' % d)
+        defines[name] = value
+
+    try:
+        vectors, loops = read_budget(args.budget, defines)
+        if args.listing:
+            with open(args.listing) as f:
+                text = f.read()
+        else:
+            text = subprocess.run([args.objdump, '-d', '-l', args.elf],
+                                  check=True, capture_output=True, text=True).stdout
+        insns, symbols = read_listing(text)
+        base = os.path.dirname(os.path.abspath(args.elf))
+        source = Source(args.source or [os.path.join(base, '..'), base])
+        analyzer = Analyzer(insns, source, loops)
+
+        failed = False
+        print('%-18s %-12s %8s %8s' % ('vector', 'path', 'cycles', 'budget'))
+        for vec in dict.fromkeys(v[0] for v in vectors):
+            symbol = '__vector_%d' % VECTORS[args.mcu][vec]
+            rules = [v for v in vectors if v[0] == vec]
+            if symbol not in symbols:
+                for v in rules:
+                    print('%-18s %-12s %8s %8d' % (vec, v[1], 'n/a', v[4]))
+                continue
+            result = analyzer.analyze(symbols[symbol], [(v[1], v[2], v[3]) for v in rules])
+            for v in rules:
+                cycles = result[v[1]]
+                if cycles is None:
+                    print('%-18s %-12s %8s %8d' % (vec, v[1], 'n/a', v[4]))
+                    continue
+                cycles += args.entry
+                flag = ''
+                if cycles > v[4]:
+                    flag = '  <-- over budget'
+                    failed = True
+                print('%-18s %-12s %8d %8d%s' % (vec, v[1], cycles, v[4], flag))
+    except (CycleError, OSError, subprocess.CalledProcessError) as e:
+        print('isr_cycles: %s' % e, file=sys.stderr)
+        return 2
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())